@@ -0,0 +1,165 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wlc/wlc.h>
+#include "headless.h"
+#include "handlers.h"
+#include "extensions.h"
+#include "layout.h"
+#include "config.h"
+#include "commands.h"
+#include "input_state.h"
+#include "ipc.h"
+#include "log.h"
+#include "clock.h"
+#include "bench.h"
+
+bool bench_running(struct bench *bench) {
+	return bench->length < bench->runs;
+}
+
+void bench_start(struct bench *bench) {
+	bench->start = clock_now_ns();
+}
+
+void bench_stop(struct bench *bench, unsigned long ops) {
+	uint64_t elapsed = clock_now_ns() - bench->start;
+	// The first pass fills caches and pools, and isn't kept
+	if (!bench->warm) {
+		bench->warm = true;
+		return;
+	}
+	bench->samples[bench->length++] = elapsed;
+	bench->ops = ops;
+}
+
+void bench_report(struct bench *bench, const char *key, int64_t value) {
+	json_object_object_add(bench->extra, key, json_object_new_int64(value));
+}
+
+void bench_fail(const char *format, ...) {
+	va_list args;
+	va_start(args, format);
+	fprintf(stderr, "sway-bench: ");
+	vfprintf(stderr, format, args);
+	fprintf(stderr, "\n");
+	va_end(args);
+	exit(1);
+}
+
+void bench_init(const char *config_text) {
+	init_log(L_ERROR);
+	wlc_init(&interface, 0, NULL);
+	register_extensions();
+	init_layout();
+	input_init();
+
+	// A config is never empty, it would have nothing to read
+	if (!config_text || !*config_text) {
+		config_text = "\n";
+	}
+	FILE *f = fmemopen((void *)config_text, strlen(config_text), "r");
+	if (!f) {
+		bench_fail("Unable to open config");
+	}
+	if (!read_config(f, false)) {
+		bench_fail("Errors in config");
+	}
+	fclose(f);
+
+	ipc_init();
+	// Removes the socket when the scenario ends
+	atexit(ipc_terminate);
+	interface.compositor.ready();
+	bench_output();
+}
+
+wlc_handle bench_output(void) {
+	static int count = 0;
+	char name[32];
+	snprintf(name, sizeof(name), "BENCH-%d", ++count);
+	wlc_handle output = headless_output_create(name, 1920, 1080);
+	if (!output) {
+		bench_fail("Unable to create output %s", name);
+	}
+	headless_clear_calls();
+	return output;
+}
+
+wlc_handle bench_view(void) {
+	static int count = 0;
+	char title[32];
+	snprintf(title, sizeof(title), "view %d", ++count);
+	wlc_handle view = headless_view_create(&(struct headless_view){
+		.output = wlc_get_focused_output(),
+		.geometry = { { 0, 0 }, { 640, 480 } },
+		.title = title,
+		.class = "sway-bench",
+		.app_id = "sway-bench",
+	});
+	if (!view) {
+		bench_fail("Unable to create %s", title);
+	}
+	// Nothing checks them, and they would pile up over a run
+	headless_clear_calls();
+	return view;
+}
+
+wlc_handle bench_floating_view(const struct wlc_geometry *geometry) {
+	wlc_handle view = headless_view_create(&(struct headless_view){
+		.output = wlc_get_focused_output(),
+		.type = WLC_BIT_MODAL,
+		.geometry = *geometry,
+		.title = "dialog",
+		.class = "sway-bench",
+		.app_id = "sway-bench",
+	});
+	if (!view) {
+		bench_fail("Unable to create floating view");
+	}
+	// Floating views are placed in the middle, until they ask to be moved
+	headless_view_request_geometry(view, geometry);
+	headless_clear_calls();
+	return view;
+}
+
+wlc_handle *bench_views(int count, int per_workspace) {
+	wlc_handle *views = malloc(count * sizeof(wlc_handle));
+	if (!views) {
+		bench_fail("Unable to allocate %d views", count);
+	}
+	int i;
+	for (i = 0; i < count; ++i) {
+		if (per_workspace && i && i % per_workspace == 0) {
+			bench_command("workspace bench-%d", i / per_workspace);
+		}
+		views[i] = bench_view();
+	}
+	return views;
+}
+
+void bench_split_views(int count) {
+	bench_view();
+	int i;
+	for (i = 1; i < count; ++i) {
+		bench_command(i % 2 ? "splitv" : "splith");
+		bench_view();
+	}
+}
+
+void bench_command(const char *format, ...) {
+	char command[256];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(command, sizeof(command), format, args);
+	va_end(args);
+
+	struct cmd_results *res = handle_command(command);
+	if (res->status != CMD_SUCCESS) {
+		bench_fail("Command '%s' failed: %s", command, res->error);
+	}
+	free_cmd_results(res);
+	arrange_windows_flush();
+	headless_clear_calls();
+}
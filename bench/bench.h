@@ -0,0 +1,108 @@
+#ifndef _SWAY_BENCH_H
+#define _SWAY_BENCH_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <json-c/json.h>
+#include <wlc/wlc.h>
+
+/**
+ * Times one scenario. Each scenario runs in a process of its own, against
+ * the headless wlc, so it can leave sway in any state when it is done.
+ */
+struct bench {
+	// Samples to keep, after one to warm up
+	int runs;
+	int length;
+	bool warm;
+	uint64_t *samples;
+	// Operations done per sample, the results are per operation
+	unsigned long ops;
+	uint64_t start;
+	// Scenario specific counts, reported along with the times
+	json_object *extra;
+};
+
+struct bench_scenario {
+	const char *name;
+	// What the size is a count of, e.g. "views"
+	const char *unit;
+	int size;
+	void (*run)(struct bench *bench, int size);
+};
+
+/**
+ * Returns true until enough samples are taken. Scenarios loop on it,
+ * timing each pass with bench_start and bench_stop.
+ */
+bool bench_running(struct bench *bench);
+void bench_start(struct bench *bench);
+void bench_stop(struct bench *bench, unsigned long ops);
+void bench_report(struct bench *bench, const char *key, int64_t value);
+/**
+ * Ends the scenario with an error, it is reported instead of its results.
+ */
+void bench_fail(const char *format, ...) __attribute__((format(printf,1,2)));
+
+/**
+ * Starts sway with the given config and one output, as the real event loop
+ * would up to handling the first event.
+ */
+void bench_init(const char *config);
+wlc_handle bench_output(void);
+/**
+ * Creates a view on the focused output and returns its handle.
+ */
+wlc_handle bench_view(void);
+/**
+ * Creates a floating view, like a dialog, and moves it to geometry.
+ */
+wlc_handle bench_floating_view(const struct wlc_geometry *geometry);
+/**
+ * Creates count views, switching to a new workspace every per_workspace views.
+ * Returns the handles, to be freed by the caller.
+ */
+wlc_handle *bench_views(int count, int per_workspace);
+/**
+ * Creates count views on the current workspace, each split off the one before
+ * it in alternating directions, for a tree count levels deep.
+ */
+void bench_split_views(int count);
+/**
+ * Runs a command like a key binding would, failing the scenario if it fails.
+ */
+void bench_command(const char *format, ...) __attribute__((format(printf,1,2)));
+
+void bench_new_view(struct bench *bench, int size);
+void bench_view_churn(struct bench *bench, int size);
+void bench_view_churn_malloc(struct bench *bench, int size);
+void bench_list_build(struct bench *bench, int size);
+void bench_list_build_fixed(struct bench *bench, int size);
+void bench_child_list(struct bench *bench, int size);
+void bench_child_list_heap(struct bench *bench, int size);
+void bench_arrange_wide(struct bench *bench, int size);
+void bench_arrange_deep(struct bench *bench, int size);
+void bench_swayc_by_handle(struct bench *bench, int size);
+void bench_swayc_by_handle_walk(struct bench *bench, int size);
+void bench_pointer_motion(struct bench *bench, int size);
+void bench_floating_hit_test(struct bench *bench, int size);
+void bench_floating_hit_test_scan(struct bench *bench, int size);
+void bench_handle_command(struct bench *bench, int size);
+void bench_handle_key_hit(struct bench *bench, int size);
+void bench_handle_key_miss(struct bench *bench, int size);
+void bench_handle_key_parsed(struct bench *bench, int size);
+void bench_binding_command(struct bench *bench, int size);
+void bench_binding_command_parsed(struct bench *bench, int size);
+void bench_binding_lookup(struct bench *bench, int size);
+void bench_binding_lookup_scan(struct bench *bench, int size);
+void bench_workspace_walk(struct bench *bench, int size);
+void bench_workspace_walk_map(struct bench *bench, int size);
+void bench_tree_walk(struct bench *bench, int size);
+void bench_tree_walk_map(struct bench *bench, int size);
+void bench_config_load(struct bench *bench, int size);
+void bench_log_disabled(struct bench *bench, int size);
+void bench_log_disabled_unchecked(struct bench *bench, int size);
+void bench_ipc_get_workspaces(struct bench *bench, int size);
+void bench_ipc_get_workspaces_deep(struct bench *bench, int size);
+void bench_ipc_get_outputs(struct bench *bench, int size);
+
+#endif
@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "config.h"
+#include "layout.h"
+#include "bench.h"
+
+// A config with variables, key bindings and workspace bindings, like a
+// long hand written one
+static char *write_config(int size) {
+	char *path = strdup("/tmp/sway-bench-config.XXXXXX");
+	int fd = mkstemp(path);
+	FILE *f = fd == -1 ? NULL : fdopen(fd, "w");
+	if (!f) {
+		bench_fail("Unable to create config %s", path);
+	}
+	int i;
+	for (i = 0; i < size; ++i) {
+		switch (i % 4) {
+		case 0:
+			fprintf(f, "set $var%d %d\n", i, i);
+			break;
+		case 1:
+			fprintf(f, "bindsym Mod4+0x%x focus left\n", 0x1000100 + i);
+			break;
+		case 2:
+			fprintf(f, "bindsym Mod4+Shift+0x%x workspace ws%d\n", 0x1000100 + i, i);
+			break;
+		case 3:
+			fprintf(f, "# comment %d\n", i);
+			break;
+		}
+	}
+	fclose(f);
+	return path;
+}
+
+// Reloads, like the reload command, with sway running and views to arrange
+void bench_config_load(struct bench *bench, int size) {
+	bench_init(NULL);
+	free(bench_views(16, 0));
+	char *path = write_config(size);
+	bool success = true;
+	while (bench_running(bench)) {
+		bench_start(bench);
+		success = load_config(path) && success;
+		arrange_windows_flush();
+		bench_stop(bench, 1);
+	}
+	unlink(path);
+	free(path);
+	if (!success) {
+		bench_fail("Errors in config");
+	}
+}
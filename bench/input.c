@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wlc/wlc.h>
+#include "headless.h"
+#include "commands.h"
+#include "config.h"
+#include "input_state.h"
+#include "layout.h"
+#include "bench.h"
+
+// Unicode keysyms, the headless wlc sends them as their own key codes
+#define BENCH_KEYSYM 0x1000100
+
+static const char *commands[] = {
+	"focus left",
+	"focus right",
+	"layout toggle split",
+	"layout toggle split",
+	"workspace other",
+	"workspace main",
+};
+
+// Commands run as a key binding would run them, each followed by its layout
+void bench_handle_command(struct bench *bench, int size) {
+	bench_init(NULL);
+	bench_command("workspace main");
+	free(bench_views(size, 0));
+
+	const int length = sizeof(commands) / sizeof(commands[0]), repeat = 100;
+	int i, j;
+	while (bench_running(bench)) {
+		bench_start(bench);
+		for (i = 0; i < repeat; ++i) {
+			for (j = 0; j < length; ++j) {
+				struct cmd_results *res = handle_command((char *)commands[j]);
+				free_cmd_results(res);
+				arrange_windows_flush();
+			}
+		}
+		bench_stop(bench, repeat * length);
+		headless_clear_calls();
+	}
+}
+
+// size bindings on Mod4 and a key each, bound to a command that changes nothing
+static void init_bindings(int size) {
+	const char *line = "bindsym Mod4+0x%x focus_follows_mouse yes\n";
+	size_t length = strlen(line) + 16;
+	char *config = malloc(size * length + 1);
+	if (!config) {
+		bench_fail("Unable to allocate config");
+	}
+	char *end = config;
+	int i;
+	for (i = 0; i < size; ++i) {
+		end += snprintf(end, length, line, BENCH_KEYSYM + i);
+	}
+	bench_init(config);
+	free(config);
+	bench_view();
+}
+
+static void time_key(struct bench *bench, uint32_t key, bool expect_handled) {
+	const int presses = 1000;
+	int i, handled = 0;
+	while (bench_running(bench)) {
+		handled = 0;
+		bench_start(bench);
+		for (i = 0; i < presses; ++i) {
+			handled += headless_key(key, WLC_BIT_MOD_LOGO, WLC_KEY_STATE_PRESSED);
+			headless_key(key, WLC_BIT_MOD_LOGO, WLC_KEY_STATE_RELEASED);
+		}
+		bench_stop(bench, presses);
+	}
+	if (handled != (expect_handled ? presses : 0)) {
+		bench_fail("%d of %d presses were bound", handled, presses);
+	}
+}
+
+void bench_handle_key_hit(struct bench *bench, int size) {
+	init_bindings(size);
+	time_key(bench, BENCH_KEYSYM + size / 2, true);
+}
+
+void bench_handle_key_miss(struct bench *bench, int size) {
+	init_bindings(size);
+	time_key(bench, BENCH_KEYSYM + size, false);
+}
+
+// Key presses as they were before bindings were compiled, with handle_key
+// parsing the binding's command on every press
+void bench_handle_key_parsed(struct bench *bench, int size) {
+	init_bindings(size);
+	list_t *bindings = config->current_mode->bindings;
+	int i;
+	for (i = 0; i < bindings->length; ++i) {
+		struct sway_binding *binding = bindings->items[i];
+		free_cmd_list(binding->compiled);
+		binding->compiled = NULL;
+	}
+	time_key(bench, BENCH_KEYSYM + size / 2, true);
+}
+
+// A binding of size chained commands, run compiled or parsed each time
+static void time_binding_command(struct bench *bench, int size, bool compiled) {
+	bench_init(NULL);
+	bench_view();
+	const char *cmd = "focus_follows_mouse yes";
+	size_t length = strlen(cmd) + 2;
+	char *command = malloc(size * length + 1);
+	if (!command) {
+		bench_fail("Unable to allocate command");
+	}
+	char *end = command;
+	int i;
+	for (i = 0; i < size; ++i) {
+		end += snprintf(end, length + 1, i ? ", %s" : "%s", cmd);
+	}
+	struct cmd_list *list = compile_command(command);
+	if (!list) {
+		bench_fail("Unable to compile '%s'", command);
+	}
+
+	const int runs = 1000;
+	while (bench_running(bench)) {
+		bench_start(bench);
+		for (i = 0; i < runs; ++i) {
+			struct cmd_results *res = compiled
+				? handle_compiled_command(list)
+				: handle_command(command);
+			if (res->status != CMD_SUCCESS) {
+				bench_fail("Command '%s' failed: %s", command, res->error);
+			}
+			free_cmd_results(res);
+		}
+		bench_stop(bench, runs);
+	}
+	free_cmd_list(list);
+	free(command);
+}
+
+void bench_binding_command(struct bench *bench, int size) {
+	time_binding_command(bench, size, true);
+}
+
+void bench_binding_command_parsed(struct bench *bench, int size) {
+	time_binding_command(bench, size, false);
+}
+
+static void time_lookup(struct bench *bench, int size,
+		struct sway_binding *(*lookup)(struct sway_mode *mode, uint32_t modifiers)) {
+	init_bindings(size);
+	uint32_t sym = BENCH_KEYSYM + size / 2;
+	press_key(sym, sym);
+	const int lookups = 10000;
+	int i, found = 0;
+	while (bench_running(bench)) {
+		found = 0;
+		bench_start(bench);
+		for (i = 0; i < lookups; ++i) {
+			found += lookup(config->current_mode, WLC_BIT_MOD_LOGO) != NULL;
+		}
+		bench_stop(bench, lookups);
+	}
+	release_key(sym, sym);
+	if (found != lookups) {
+		bench_fail("Found %d of %d bindings", found, lookups);
+	}
+}
+
+void bench_binding_lookup(struct bench *bench, int size) {
+	time_lookup(bench, size, get_pressed_binding);
+}
+
+// How handle_key found the binding before bindings were hashed, checking
+// every binding of the mode in turn
+static struct sway_binding *scan_pressed_binding(struct sway_mode *mode, uint32_t modifiers) {
+	int i;
+	for (i = 0; i < mode->bindings->length; ++i) {
+		struct sway_binding *binding = mode->bindings->items[i];
+
+		if ((modifiers ^ binding->modifiers) == 0) {
+			bool match = false;
+			int j;
+			for (j = 0; j < binding->keys->length; ++j) {
+				xkb_keysym_t *key = binding->keys->items[j];
+				if ((match = check_key(*key, 0)) == false) {
+					break;
+				}
+			}
+			if (match) {
+				return binding;
+			}
+		}
+	}
+	return NULL;
+}
+
+void bench_binding_lookup_scan(struct bench *bench, int size) {
+	time_lookup(bench, size, scan_pressed_binding);
+}
@@ -0,0 +1,104 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "headless.h"
+#include "ipc.h"
+#include "bench.h"
+
+static const char ipc_magic[] = {'i', '3', '-', 'i', 'p', 'c'};
+
+#define IPC_HEADER_SIZE (sizeof(ipc_magic) + 8)
+
+// Connects to the IPC socket and has sway accept the connection
+static int ipc_connect(void) {
+	const char *path = getenv("SWAYSOCK");
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd == -1 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+		bench_fail("Unable to connect to %s: %s", path, strerror(errno));
+	}
+	headless_dispatch(-1);
+	return fd;
+}
+
+static void ipc_recv(int fd, void *buf, size_t length) {
+	if (recv(fd, buf, length, MSG_WAITALL) != (ssize_t)length) {
+		bench_fail("Unable to receive IPC reply: %s", strerror(errno));
+	}
+}
+
+// Sends a request without payload and returns the length of the reply. sway
+// writes the reply while handling the request, so it is waiting by the time
+// headless_dispatch returns.
+static uint32_t ipc_query(int fd, enum ipc_command_type type, char **reply, size_t *size) {
+	char header[IPC_HEADER_SIZE];
+	uint32_t *header32 = (uint32_t *)(header + sizeof(ipc_magic));
+	memcpy(header, ipc_magic, sizeof(ipc_magic));
+	header32[0] = 0;
+	header32[1] = type;
+	if (write(fd, header, IPC_HEADER_SIZE) != (ssize_t)IPC_HEADER_SIZE) {
+		bench_fail("Unable to send IPC request: %s", strerror(errno));
+	}
+	headless_dispatch(-1);
+
+	ipc_recv(fd, header, IPC_HEADER_SIZE);
+	uint32_t length = header32[0];
+	if (length > *size) {
+		*reply = realloc(*reply, *size = length);
+		if (!*reply) {
+			bench_fail("Unable to allocate %u byte reply", length);
+		}
+	}
+	ipc_recv(fd, *reply, length);
+	return length;
+}
+
+static void time_query(struct bench *bench, enum ipc_command_type type) {
+	int fd = ipc_connect();
+	const int queries = 100;
+	char *reply = NULL;
+	size_t size = 0;
+	uint32_t length = 0;
+	int i;
+	while (bench_running(bench)) {
+		bench_start(bench);
+		for (i = 0; i < queries; ++i) {
+			length = ipc_query(fd, type, &reply, &size);
+		}
+		bench_stop(bench, queries);
+	}
+	bench_report(bench, "reply_bytes", length);
+	free(reply);
+	close(fd);
+}
+
+// size workspaces, of two views each
+void bench_ipc_get_workspaces(struct bench *bench, int size) {
+	bench_init(NULL);
+	free(bench_views(size * 2, 2));
+	time_query(bench, IPC_GET_WORKSPACES);
+}
+
+// Ten workspaces, each size levels deep
+void bench_ipc_get_workspaces_deep(struct bench *bench, int size) {
+	bench_init(NULL);
+	int i;
+	for (i = 0; i < 10; ++i) {
+		bench_command("workspace bench-%d", i);
+		bench_split_views(size);
+	}
+	time_query(bench, IPC_GET_WORKSPACES);
+}
+
+void bench_ipc_get_outputs(struct bench *bench, int size) {
+	bench_init(NULL);
+	int i;
+	for (i = 1; i < size; ++i) {
+		bench_output();
+	}
+	time_query(bench, IPC_GET_OUTPUTS);
+}
@@ -0,0 +1,98 @@
+#include "container.h"
+#include "bench.h"
+
+#define WORKSPACES 10
+
+// Ten workspaces, each size levels deep
+static void init_workspaces(int size) {
+	bench_init(NULL);
+	int i;
+	for (i = 0; i < WORKSPACES; ++i) {
+		bench_command("workspace bench-%d", i);
+		bench_split_views(size);
+	}
+}
+
+static int iter_count(enum swayc_types type) {
+	struct swayc_iter iter;
+	swayc_iter_init(&iter, &root_container, type);
+	swayc_t *container;
+	int count = 0;
+	while ((container = swayc_iter_next(&iter))) {
+		count += container->type == type;
+	}
+	return count;
+}
+
+// container_map before it was built on the iterator, recursing over the whole
+// tree whatever the callback is looking for
+static void recursive_map(swayc_t *container, void (*f)(swayc_t *view, void *data), void *data) {
+	if (container) {
+		f(container, data);
+		int i;
+		if (container->children)  {
+			for (i = 0; i < container->children->length; ++i) {
+				swayc_t *child = container->children->items[i];
+				recursive_map(child, f, data);
+			}
+		}
+		if (container->floating) {
+			for (i = 0; i < container->floating->length; ++i) {
+				swayc_t *child = container->floating->items[i];
+				recursive_map(child, f, data);
+			}
+		}
+	}
+}
+
+struct map_count {
+	enum swayc_types type;
+	int count;
+};
+
+static void count_type(swayc_t *container, void *data) {
+	struct map_count *count = data;
+	count->count += container->type == count->type;
+}
+
+static int map_count(enum swayc_types type) {
+	struct map_count count = { type, 0 };
+	recursive_map(&root_container, count_type, &count);
+	return count.count;
+}
+
+static void time_walk(struct bench *bench, int size, enum swayc_types type,
+		int (*walk)(enum swayc_types type)) {
+	init_workspaces(size);
+	const int walks = 1000;
+	int i, found = 0;
+	while (bench_running(bench)) {
+		bench_start(bench);
+		for (i = 0; i < walks; ++i) {
+			found = walk(type);
+		}
+		bench_stop(bench, walks);
+	}
+	if (found != iter_count(type) || found != map_count(type)) {
+		bench_fail("Iterator and map disagree on the number of containers");
+	}
+	bench_report(bench, "found", found);
+}
+
+// Finding the workspaces, as GET_WORKSPACES does
+void bench_workspace_walk(struct bench *bench, int size) {
+	time_walk(bench, size, C_WORKSPACE, iter_count);
+}
+
+void bench_workspace_walk_map(struct bench *bench, int size) {
+	time_walk(bench, size, C_WORKSPACE, map_count);
+}
+
+// Visiting every view
+void bench_tree_walk(struct bench *bench, int size) {
+	time_walk(bench, size, C_VIEW, iter_count);
+}
+
+void bench_tree_walk_map(struct bench *bench, int size) {
+	time_walk(bench, size, C_VIEW, map_count);
+}
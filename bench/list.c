@@ -0,0 +1,72 @@
+#include <stdlib.h>
+#include "list.h"
+#include "bench.h"
+
+// Capacity changes are reallocations, except the first one out of an inline
+// list, which is a malloc
+static void time_build(struct bench *bench, int size, void (*add)(list_t *list, void *item)) {
+	const int lists = 10;
+	int i, j, resized = 0;
+	while (bench_running(bench)) {
+		resized = 0;
+		bench_start(bench);
+		for (i = 0; i < lists; ++i) {
+			list_t *list = create_list();
+			int capacity = list->capacity;
+			for (j = 0; j < size; ++j) {
+				add(list, &list);
+				if (list->capacity != capacity) {
+					capacity = list->capacity;
+					++resized;
+				}
+			}
+			list_free(list);
+		}
+		bench_stop(bench, lists * size);
+	}
+	bench_report(bench, "resizes", resized / lists);
+}
+
+void bench_list_build(struct bench *bench, int size) {
+	time_build(bench, size, list_add);
+}
+
+// list_add before lists grew geometrically, ten slots at a time
+static void fixed_list_add(list_t *list, void *item) {
+	if (list->length == list->capacity) {
+		list->capacity += 10;
+		list->items = realloc(list->items, sizeof(void*) * list->capacity);
+	}
+	list->items[list->length++] = item;
+}
+
+void bench_list_build_fixed(struct bench *bench, int size) {
+	time_build(bench, size, fixed_list_add);
+}
+
+// Child lists as containers use them, created, filled with a few children and
+// freed again
+static void time_child_list(struct bench *bench, int size, bool inline_items) {
+	const int lists = 10000;
+	int i, j;
+	while (bench_running(bench)) {
+		bench_start(bench);
+		for (i = 0; i < lists; ++i) {
+			list_t *list = inline_items ? create_list_inline(4) : create_list();
+			for (j = 0; j < size; ++j) {
+				list_add(list, &list);
+			}
+			list_del(list, 0);
+			list_free(list);
+		}
+		bench_stop(bench, lists);
+	}
+}
+
+void bench_child_list(struct bench *bench, int size) {
+	time_child_list(bench, size, true);
+}
+
+void bench_child_list_heap(struct bench *bench, int size) {
+	time_child_list(bench, size, false);
+}
@@ -0,0 +1,55 @@
+#include <stdlib.h>
+#include <wlc/wlc.h>
+#include "log.h"
+#include "bench.h"
+
+// The debug line handle_view_created logs for each new view
+#define LOG_VIEW(LOG, handle) \
+	LOG(L_DEBUG, "handle:%ld type:%x state:%x " \
+			"mask:%d (x:%d y:%d w:%d h:%d) title:%s " \
+			"class:%s appid:%s", \
+		handle, wlc_view_get_type(handle), wlc_view_get_state(handle), \
+		wlc_view_get_mask(handle), wlc_view_get_geometry(handle)->origin.x, \
+		wlc_view_get_geometry(handle)->origin.y, wlc_view_get_geometry(handle)->size.w, \
+		wlc_view_get_geometry(handle)->size.h, wlc_view_get_title(handle), \
+		wlc_view_get_class(handle), wlc_view_get_app_id(handle))
+
+// sway_log before the macro checked the level, leaving it to _sway_log after
+// the arguments were evaluated
+#ifndef NDEBUG
+#define unchecked_log(VERBOSITY, FMT, ...) \
+	_sway_log(__FILE__, __LINE__, VERBOSITY, FMT, ##__VA_ARGS__)
+#else
+#define unchecked_log(VERBOSITY, FMT, ...) \
+	_sway_log(VERBOSITY, FMT, ##__VA_ARGS__)
+#endif
+
+static void time_log(struct bench *bench, int size, bool checked) {
+	bench_init(NULL);
+	wlc_handle *views = bench_views(size, 0);
+	const int repeat = 1000;
+	int i, j;
+	while (bench_running(bench)) {
+		bench_start(bench);
+		for (i = 0; i < repeat; ++i) {
+			for (j = 0; j < size; ++j) {
+				if (checked) {
+					LOG_VIEW(sway_log, views[j]);
+				} else {
+					LOG_VIEW(unchecked_log, views[j]);
+				}
+			}
+		}
+		bench_stop(bench, repeat * size);
+	}
+	free(views);
+}
+
+// Debug messages with logging at errors only, as sway runs by default
+void bench_log_disabled(struct bench *bench, int size) {
+	time_log(bench, size, true);
+}
+
+void bench_log_disabled_unchecked(struct bench *bench, int size) {
+	time_log(bench, size, false);
+}
@@ -0,0 +1,310 @@
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <json-c/json.h>
+#include <wlc/wlc.h>
+#include "sway.h"
+#include "bench.h"
+
+static const struct bench_scenario scenarios[] = {
+	{ "new_view", "views", 100, bench_new_view },
+	{ "new_view", "views", 1000, bench_new_view },
+	{ "view_churn", "views", 16, bench_view_churn },
+	{ "view_churn_malloc", "views", 16, bench_view_churn_malloc },
+	{ "list_build", "items", 100, bench_list_build },
+	{ "list_build", "items", 10000, bench_list_build },
+	{ "list_build", "items", 100000, bench_list_build },
+	{ "list_build_fixed", "items", 100, bench_list_build_fixed },
+	{ "list_build_fixed", "items", 10000, bench_list_build_fixed },
+	{ "list_build_fixed", "items", 100000, bench_list_build_fixed },
+	{ "child_list", "items", 2, bench_child_list },
+	{ "child_list", "items", 8, bench_child_list },
+	{ "child_list_heap", "items", 2, bench_child_list_heap },
+	{ "child_list_heap", "items", 8, bench_child_list_heap },
+	{ "arrange_wide", "views", 100, bench_arrange_wide },
+	{ "arrange_wide", "views", 1000, bench_arrange_wide },
+	{ "arrange_deep", "levels", 16, bench_arrange_deep },
+	{ "arrange_deep", "levels", 128, bench_arrange_deep },
+	{ "swayc_by_handle", "views", 100, bench_swayc_by_handle },
+	{ "swayc_by_handle", "views", 1000, bench_swayc_by_handle },
+	{ "swayc_by_handle", "views", 10000, bench_swayc_by_handle },
+	{ "swayc_by_handle_walk", "views", 100, bench_swayc_by_handle_walk },
+	{ "swayc_by_handle_walk", "views", 1000, bench_swayc_by_handle_walk },
+	{ "swayc_by_handle_walk", "views", 10000, bench_swayc_by_handle_walk },
+	{ "workspace_walk", "levels", 16, bench_workspace_walk },
+	{ "workspace_walk", "levels", 128, bench_workspace_walk },
+	{ "workspace_walk_map", "levels", 16, bench_workspace_walk_map },
+	{ "workspace_walk_map", "levels", 128, bench_workspace_walk_map },
+	{ "tree_walk", "levels", 16, bench_tree_walk },
+	{ "tree_walk", "levels", 128, bench_tree_walk },
+	{ "tree_walk_map", "levels", 16, bench_tree_walk_map },
+	{ "tree_walk_map", "levels", 128, bench_tree_walk_map },
+	{ "pointer_motion", "floating", 10, bench_pointer_motion },
+	{ "pointer_motion", "floating", 500, bench_pointer_motion },
+	{ "floating_hit_test", "floating", 10, bench_floating_hit_test },
+	{ "floating_hit_test", "floating", 100, bench_floating_hit_test },
+	{ "floating_hit_test", "floating", 500, bench_floating_hit_test },
+	{ "floating_hit_test_scan", "floating", 10, bench_floating_hit_test_scan },
+	{ "floating_hit_test_scan", "floating", 100, bench_floating_hit_test_scan },
+	{ "floating_hit_test_scan", "floating", 500, bench_floating_hit_test_scan },
+	{ "handle_command", "views", 16, bench_handle_command },
+	{ "handle_key_hit", "bindings", 10, bench_handle_key_hit },
+	{ "handle_key_hit", "bindings", 100, bench_handle_key_hit },
+	{ "handle_key_hit", "bindings", 1000, bench_handle_key_hit },
+	{ "handle_key_miss", "bindings", 10, bench_handle_key_miss },
+	{ "handle_key_miss", "bindings", 1000, bench_handle_key_miss },
+	{ "handle_key_parsed", "bindings", 10, bench_handle_key_parsed },
+	{ "handle_key_parsed", "bindings", 100, bench_handle_key_parsed },
+	{ "handle_key_parsed", "bindings", 1000, bench_handle_key_parsed },
+	{ "binding_lookup", "bindings", 10, bench_binding_lookup },
+	{ "binding_lookup", "bindings", 100, bench_binding_lookup },
+	{ "binding_lookup", "bindings", 1000, bench_binding_lookup },
+	{ "binding_lookup_scan", "bindings", 10, bench_binding_lookup_scan },
+	{ "binding_lookup_scan", "bindings", 100, bench_binding_lookup_scan },
+	{ "binding_lookup_scan", "bindings", 1000, bench_binding_lookup_scan },
+	{ "binding_command", "commands", 1, bench_binding_command },
+	{ "binding_command", "commands", 4, bench_binding_command },
+	{ "binding_command_parsed", "commands", 1, bench_binding_command_parsed },
+	{ "binding_command_parsed", "commands", 4, bench_binding_command_parsed },
+	{ "config_load", "lines", 1000, bench_config_load },
+	{ "config_load", "lines", 2000, bench_config_load },
+	{ "log_disabled", "views", 10, bench_log_disabled },
+	{ "log_disabled_unchecked", "views", 10, bench_log_disabled_unchecked },
+	{ "ipc_get_workspaces", "workspaces", 10, bench_ipc_get_workspaces },
+	{ "ipc_get_workspaces", "workspaces", 100, bench_ipc_get_workspaces },
+	{ "ipc_get_workspaces_deep", "levels", 16, bench_ipc_get_workspaces_deep },
+	{ "ipc_get_workspaces_deep", "levels", 128, bench_ipc_get_workspaces_deep },
+	{ "ipc_get_outputs", "outputs", 1, bench_ipc_get_outputs },
+	{ "ipc_get_outputs", "outputs", 8, bench_ipc_get_outputs },
+};
+
+static const int scenarios_length = sizeof(scenarios) / sizeof(scenarios[0]);
+
+// There is no event loop to leave, an exit command ends the scenario
+void sway_terminate(void) {
+	wlc_terminate();
+}
+
+static int compare_samples(const void *_a, const void *_b) {
+	uint64_t a = *(const uint64_t *)_a, b = *(const uint64_t *)_b;
+	return a < b ? -1 : a > b;
+}
+
+// Runs in the scenario's process, results go to fd as a JSON object
+static void run_scenario(const struct bench_scenario *scenario, int runs, int fd) {
+	struct bench bench = {
+		.runs = runs,
+		.samples = calloc(runs, sizeof(uint64_t)),
+		.extra = json_object_new_object(),
+	};
+	if (!bench.samples) {
+		bench_fail("Unable to allocate samples");
+	}
+	scenario->run(&bench, scenario->size);
+	if (bench.length == 0 || bench.ops == 0) {
+		bench_fail("No samples taken");
+	}
+
+	qsort(bench.samples, bench.length, sizeof(uint64_t), compare_samples);
+	uint64_t total = 0;
+	int i;
+	for (i = 0; i < bench.length; ++i) {
+		total += bench.samples[i];
+	}
+	int64_t min = bench.samples[0] / bench.ops;
+	int64_t median = bench.samples[bench.length / 2] / bench.ops;
+	int64_t mean = total / bench.length / bench.ops;
+	int64_t max = bench.samples[bench.length - 1] / bench.ops;
+
+	json_object *result = json_object_new_object();
+	json_object_object_add(result, "ops", json_object_new_int64(bench.ops));
+	json_object_object_add(result, "samples", json_object_new_int(bench.length));
+	json_object_object_add(result, "min_ns", json_object_new_int64(min));
+	json_object_object_add(result, "median_ns", json_object_new_int64(median));
+	json_object_object_add(result, "mean_ns", json_object_new_int64(mean));
+	json_object_object_add(result, "max_ns", json_object_new_int64(max));
+	json_object_object_add(result, "extra", bench.extra);
+
+	const char *json = json_object_to_json_string(result);
+	size_t length = strlen(json);
+	while (length > 0) {
+		ssize_t written = write(fd, json, length);
+		if (written == -1) {
+			bench_fail("Unable to send results: %s", strerror(errno));
+		}
+		json += written;
+		length -= written;
+	}
+	fprintf(stderr, "%-24s %6d %-10s %12lld ns/op (min %lld, max %lld)\n",
+			scenario->name, scenario->size, scenario->unit,
+			(long long)median, (long long)min, (long long)max);
+}
+
+static json_object *fork_scenario(const struct bench_scenario *scenario, int runs) {
+	int fds[2];
+	if (pipe(fds) == -1) {
+		perror("sway-bench: pipe");
+		exit(1);
+	}
+	fflush(NULL);
+	pid_t pid = fork();
+	if (pid == -1) {
+		perror("sway-bench: fork");
+		exit(1);
+	}
+	if (pid == 0) {
+		close(fds[0]);
+		// Don't replace or talk to a running sway
+		unsetenv("SWAYSOCK");
+		unsetenv("I3SOCK");
+		run_scenario(scenario, runs, fds[1]);
+		exit(0);
+	}
+	close(fds[1]);
+
+	size_t length = 0, size = 1024;
+	char *buf = malloc(size);
+	ssize_t received;
+	while (buf && (received = read(fds[0], buf + length, size - length - 1)) > 0) {
+		length += received;
+		if (length + 1 == size) {
+			buf = realloc(buf, size *= 2);
+		}
+	}
+	close(fds[0]);
+
+	int status;
+	struct rusage usage;
+	if (wait4(pid, &status, 0, &usage) == -1) {
+		perror("sway-bench: wait4");
+		exit(1);
+	}
+
+	json_object *result = NULL;
+	if (buf && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+		buf[length] = '\0';
+		result = json_tokener_parse(buf);
+	}
+	free(buf);
+	if (!result) {
+		char error[64];
+		if (WIFSIGNALED(status)) {
+			snprintf(error, sizeof(error), "killed by signal %d", WTERMSIG(status));
+		} else {
+			snprintf(error, sizeof(error), "exited with status %d", WEXITSTATUS(status));
+		}
+		fprintf(stderr, "%-24s %6d %-10s %s\n", scenario->name, scenario->size, scenario->unit, error);
+		result = json_object_new_object();
+		json_object_object_add(result, "error", json_object_new_string(error));
+	} else {
+		json_object_object_add(result, "max_rss_kb", json_object_new_int64(usage.ru_maxrss));
+	}
+	json_object_object_add(result, "name", json_object_new_string(scenario->name));
+	json_object_object_add(result, "unit", json_object_new_string(scenario->unit));
+	json_object_object_add(result, "size", json_object_new_int(scenario->size));
+	return result;
+}
+
+// Scenarios are picked by name, or by name and size as in "new_view/1000"
+static bool scenario_selected(const struct bench_scenario *scenario, int argc, char **argv) {
+	if (argc == 0) {
+		return true;
+	}
+	char name[64];
+	snprintf(name, sizeof(name), "%s/%d", scenario->name, scenario->size);
+	int i;
+	for (i = 0; i < argc; ++i) {
+		if (strcmp(argv[i], scenario->name) == 0 || strcmp(argv[i], name) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void usage(const char *name) {
+	fprintf(stderr,
+		"Usage: %s [options] [scenario[/size]...]\n"
+		"\n"
+		"  -h, --help             Show help message and quit.\n"
+		"  -l, --list             List the scenarios and quit.\n"
+		"  -o, --output <path>    Write the JSON results to path instead of stdout.\n"
+		"  -r, --runs <count>     Samples to take of each scenario (default 10).\n",
+		name);
+}
+
+int main(int argc, char **argv) {
+	static struct option long_options[] = {
+		{"help", no_argument, NULL, 'h'},
+		{"list", no_argument, NULL, 'l'},
+		{"output", required_argument, NULL, 'o'},
+		{"runs", required_argument, NULL, 'r'},
+		{0, 0, 0, 0}
+	};
+
+	char *output_path = NULL;
+	int runs = 10;
+	int i, c;
+	while (1) {
+		int option_index = 0;
+		c = getopt_long(argc, argv, "hlo:r:", long_options, &option_index);
+		if (c == -1) {
+			break;
+		}
+		switch (c) {
+		case 'l': // list
+			for (i = 0; i < scenarios_length; ++i) {
+				printf("%s/%d\n", scenarios[i].name, scenarios[i].size);
+			}
+			exit(0);
+			break;
+		case 'o': // output
+			output_path = optarg;
+			break;
+		case 'r': // runs
+			runs = atoi(optarg);
+			if (runs < 1) {
+				fprintf(stderr, "sway-bench: runs must be at least 1\n");
+				exit(1);
+			}
+			break;
+		default:
+			usage(argv[0]);
+			exit(c == 'h' ? 0 : 1);
+		}
+	}
+
+	json_object *results = json_object_new_array();
+	for (i = 0; i < scenarios_length; ++i) {
+		if (scenario_selected(&scenarios[i], argc - optind, argv + optind)) {
+			json_object_array_add(results, fork_scenario(&scenarios[i], runs));
+		}
+	}
+	if (json_object_array_length(results) == 0) {
+		fprintf(stderr, "sway-bench: no scenario matches\n");
+		exit(1);
+	}
+
+	json_object *root = json_object_new_object();
+#if defined SWAY_GIT_VERSION
+	json_object_object_add(root, "version", json_object_new_string(SWAY_GIT_VERSION));
+#endif
+	json_object_object_add(root, "runs", json_object_new_int(runs));
+	json_object_object_add(root, "scenarios", results);
+
+	FILE *out = stdout;
+	if (output_path && !(out = fopen(output_path, "w"))) {
+		fprintf(stderr, "sway-bench: unable to open %s: %s\n", output_path, strerror(errno));
+		exit(1);
+	}
+	fprintf(out, "%s\n", json_object_to_json_string(root));
+	if (out != stdout) {
+		fclose(out);
+	}
+	json_object_put(root);
+	return 0;
+}
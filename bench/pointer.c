@@ -0,0 +1,153 @@
+#include <stdlib.h>
+#include <wlc/wlc.h>
+#include "headless.h"
+#include "container.h"
+#include "layout.h"
+#include "bench.h"
+
+#define POSITIONS 1000
+
+static struct wlc_point positions[POSITIONS];
+
+// A few tiled views under size dialogs spread over the output, some of them
+// raised, and the same pseudo random pointer positions for every run
+static void init_floating(int size) {
+	bench_init(NULL);
+	free(bench_views(4, 0));
+	unsigned int seed = 1;
+	int i;
+	for (i = 0; i < size; ++i) {
+		struct wlc_geometry geometry = { { 0, 0 }, { 300, 200 } };
+		seed = seed * 1103515245 + 12345;
+		geometry.origin.x = (seed >> 8) % (1920 - 300);
+		seed = seed * 1103515245 + 12345;
+		geometry.origin.y = (seed >> 8) % (1080 - 200);
+		bench_floating_view(&geometry);
+	}
+	// Clicking a dialog raises it, so the stacking order isn't creation order
+	swayc_t *ws = swayc_active_workspace();
+	for (i = 0; i < size; i += 7) {
+		raise_floating(ws->floating->items[i]);
+	}
+	// Away from the edges, where the pointer would move to other outputs
+	for (i = 0; i < POSITIONS; ++i) {
+		seed = seed * 1103515245 + 12345;
+		positions[i].x = 1 + (seed >> 8) % 1918;
+		seed = seed * 1103515245 + 12345;
+		positions[i].y = 1 + (seed >> 8) % 1078;
+	}
+}
+
+// Motion events as wlc sends them, including focus following the pointer
+void bench_pointer_motion(struct bench *bench, int size) {
+	init_floating(size);
+	int i;
+	while (bench_running(bench)) {
+		bench_start(bench);
+		for (i = 0; i < POSITIONS; ++i) {
+			headless_pointer_motion(positions[i].x, positions[i].y);
+		}
+		bench_stop(bench, POSITIONS);
+		headless_clear_calls();
+	}
+}
+
+static void time_hit_test(struct bench *bench, swayc_t *(*under_pointer)(void)) {
+	int i, floating = 0;
+	while (bench_running(bench)) {
+		floating = 0;
+		bench_start(bench);
+		for (i = 0; i < POSITIONS; ++i) {
+			wlc_pointer_set_position(&positions[i]);
+			swayc_t *view = under_pointer();
+			floating += view && view->is_floating;
+		}
+		bench_stop(bench, POSITIONS);
+	}
+	bench_report(bench, "floating_hits", floating);
+}
+
+void bench_floating_hit_test(struct bench *bench, int size) {
+	init_floating(size);
+	time_hit_test(bench, container_under_pointer);
+}
+
+// container_under_pointer before floating views were indexed, testing each of
+// them from the top down
+
+static bool scan_pointer_test(swayc_t *view, void *_origin) {
+	const struct wlc_point *origin = _origin;
+	// Determine the output that the view is under
+	swayc_t *parent = swayc_parent_by_type(view, C_OUTPUT);
+	if (origin->x >= view->x && origin->y >= view->y
+		&& origin->x < view->x + view->width && origin->y < view->y + view->height
+		&& view->visible && parent == root_container.focused) {
+		return true;
+	}
+	return false;
+}
+
+static swayc_t *scan_under_pointer(void) {
+	// root.output->workspace
+	if (!root_container.focused || !root_container.focused->focused) {
+		return NULL;
+	}
+	swayc_t *lookup = root_container.focused->focused;
+	// Case of empty workspace
+	if (lookup->children == 0) {
+		return NULL;
+	}
+	struct wlc_point origin;
+	wlc_pointer_get_position(&origin);
+	while (lookup->type != C_VIEW) {
+		int i;
+		int len;
+		// if tabbed/stacked go directly to focused container, otherwise search
+		// children
+		if (lookup->layout == L_TABBED || lookup->layout == L_STACKED) {
+			lookup = lookup->focused;
+			continue;
+		}
+		// if workspace, search floating
+		if (lookup->type == C_WORKSPACE) {
+			i = len = lookup->floating->length;
+			bool got_floating = false;
+			while (--i > -1) {
+				if (scan_pointer_test(lookup->floating->items[i], &origin)) {
+					lookup = lookup->floating->items[i];
+					got_floating = true;
+					break;
+				}
+			}
+			if (got_floating) {
+				continue;
+			}
+		}
+		// search children
+		len = lookup->children->length;
+		for (i = 0; i < len; ++i) {
+			if (scan_pointer_test(lookup->children->items[i], &origin)) {
+				lookup = lookup->children->items[i];
+				break;
+			}
+		}
+		// when border and titles are done, this could happen
+		if (i == len) {
+			break;
+		}
+	}
+	return lookup;
+}
+
+void bench_floating_hit_test_scan(struct bench *bench, int size) {
+	init_floating(size);
+	// Both have to find the same views for the comparison to mean anything
+	int i;
+	for (i = 0; i < POSITIONS; ++i) {
+		wlc_pointer_set_position(&positions[i]);
+		if (scan_under_pointer() != container_under_pointer()) {
+			bench_fail("Scan and index disagree at %d, %d", positions[i].x, positions[i].y);
+		}
+	}
+	time_hit_test(bench, scan_under_pointer);
+}
@@ -0,0 +1,161 @@
+#include <stdlib.h>
+#include <wlc/wlc.h>
+#include "headless.h"
+#include "container.h"
+#include "layout.h"
+#include "bench.h"
+
+// Views are created and destroyed through wlc, so each one is also arranged
+void bench_new_view(struct bench *bench, int size) {
+	bench_init(NULL);
+	wlc_handle *views = malloc(size * sizeof(wlc_handle));
+	int i;
+	while (bench_running(bench)) {
+		bench_start(bench);
+		for (i = 0; i < size; ++i) {
+			views[i] = bench_view();
+		}
+		bench_stop(bench, size);
+		for (i = 0; i < size; ++i) {
+			headless_view_destroy(views[i]);
+			headless_clear_calls();
+		}
+	}
+	free(views);
+}
+
+// Views come and go while size others stay open, as terminals and popups do
+static void time_view_churn(struct bench *bench, int size) {
+	const int cycles = 10000;
+	wlc_handle *views = bench_views(size, 0);
+	int i, oldest = 0;
+	while (bench_running(bench)) {
+		bench_start(bench);
+		for (i = 0; i < cycles; ++i) {
+			headless_view_destroy(views[oldest]);
+			views[oldest] = bench_view();
+			oldest = (oldest + 1) % size;
+		}
+		bench_stop(bench, cycles);
+	}
+	const struct swayc_pool_stats *stats = swayc_pool_stats(C_VIEW);
+	bench_report(bench, "allocated", stats->allocated);
+	bench_report(bench, "reused", stats->reused);
+	free(views);
+}
+
+void bench_view_churn(struct bench *bench, int size) {
+	bench_init(NULL);
+	time_view_churn(bench, size);
+}
+
+// Every container is allocated and freed, as before containers were pooled
+void bench_view_churn_malloc(struct bench *bench, int size) {
+	bench_init(NULL);
+	swayc_pool_set_size(0);
+	time_view_churn(bench, size);
+}
+
+// Resizes the output back and forth, so every view gets a new geometry
+static void time_output_resize(struct bench *bench) {
+	wlc_handle output = wlc_get_focused_output();
+	struct wlc_size size = *wlc_output_get_resolution(output);
+	size_t i, length;
+	int sent = 0;
+	while (bench_running(bench)) {
+		size.w = size.w == 1920 ? 1600 : 1920;
+		headless_clear_calls();
+		bench_start(bench);
+		wlc_output_set_resolution(output, &size);
+		bench_stop(bench, 1);
+		const struct headless_call *calls = headless_get_calls(&length);
+		for (i = 0, sent = 0; i < length; ++i) {
+			sent += calls[i].type == HEADLESS_SET_GEOMETRY;
+		}
+	}
+	bench_report(bench, "geometry_sent", sent);
+}
+
+void bench_arrange_wide(struct bench *bench, int size) {
+	bench_init(NULL);
+	free(bench_views(size, 0));
+	time_output_resize(bench);
+}
+
+void bench_arrange_deep(struct bench *bench, int size) {
+	bench_init(NULL);
+	bench_split_views(size);
+	time_output_resize(bench);
+}
+
+static void time_lookups(struct bench *bench, int size, swayc_t *(*lookup)(wlc_handle handle)) {
+	bench_init(NULL);
+	wlc_handle *views = bench_views(size, 100);
+
+	// The same pseudo random order for every run
+	const int lookups = 10000;
+	wlc_handle *order = malloc(lookups * sizeof(wlc_handle));
+	unsigned int seed = 1;
+	int i, found = 0;
+	for (i = 0; i < lookups; ++i) {
+		seed = seed * 1103515245 + 12345;
+		order[i] = views[(seed >> 16) % size];
+	}
+	while (bench_running(bench)) {
+		found = 0;
+		bench_start(bench);
+		for (i = 0; i < lookups; ++i) {
+			found += lookup(order[i]) != NULL;
+		}
+		bench_stop(bench, lookups);
+	}
+	if (found != lookups) {
+		bench_fail("Found %d of %d views", found, lookups);
+	}
+	free(order);
+	free(views);
+}
+
+void bench_swayc_by_handle(struct bench *bench, int size) {
+	time_lookups(bench, size, swayc_by_handle);
+}
+
+// The tree walk swayc_by_handle did before containers were indexed by handle
+static swayc_t *walk_by_handle(wlc_handle handle, swayc_t *parent) {
+	if (!parent || !parent->children) {
+		return NULL;
+	}
+	int i, len;
+	swayc_t **child;
+	if (parent->type == C_WORKSPACE) {
+		len = parent->floating->length;
+		child = (swayc_t **)parent->floating->items;
+		for (i = 0; i < len; ++i, ++child) {
+			if ((*child)->handle == handle) {
+				return *child;
+			}
+		}
+	}
+
+	len = parent->children->length;
+	child = (swayc_t **)parent->children->items;
+	for (i = 0; i < len; ++i, ++child) {
+		if ((*child)->handle == handle) {
+			return *child;
+		} else {
+			swayc_t *res;
+			if ((res = walk_by_handle(handle, *child))) {
+				return res;
+			}
+		}
+	}
+	return NULL;
+}
+
+static swayc_t *swayc_by_handle_walk(wlc_handle handle) {
+	return walk_by_handle(handle, &root_container);
+}
+
+void bench_swayc_by_handle_walk(struct bench *bench, int size) {
+	time_lookups(bench, size, swayc_by_handle_walk);
+}
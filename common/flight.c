@@ -0,0 +1,64 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "clock.h"
+#include "flight.h"
+
+// Number of events kept, a power of two
+#define FLIGHT_RING_SIZE 512
+#define FLIGHT_DETAIL_SIZE 40
+
+struct flight_event {
+	uint64_t time;
+	enum flight_event_type type;
+	const void *object;
+	char detail[FLIGHT_DETAIL_SIZE];
+};
+
+static struct flight_event ring[FLIGHT_RING_SIZE];
+// Total number of events recorded, the next slot is count % FLIGHT_RING_SIZE
+static unsigned long count = 0;
+
+static const char *type_names[] = {
+	[FLIGHT_WLC] = "wlc",
+	[FLIGHT_COMMAND] = "command",
+	[FLIGHT_ARRANGE] = "arrange",
+	[FLIGHT_FOCUS] = "focus",
+};
+
+void flight_record(enum flight_event_type type, const void *object, const char *detail) {
+	struct flight_event *event = &ring[count++ & (FLIGHT_RING_SIZE - 1)];
+	event->time = clock_now_ns();
+	event->type = type;
+	event->object = object;
+	if (detail) {
+		strncpy(event->detail, detail, FLIGHT_DETAIL_SIZE - 1);
+		event->detail[FLIGHT_DETAIL_SIZE - 1] = '\0';
+	} else {
+		event->detail[0] = '\0';
+	}
+}
+
+void flight_dump(int fd) {
+	char line[128];
+	unsigned long end = count;
+	unsigned long start = end > FLIGHT_RING_SIZE ? end - FLIGHT_RING_SIZE : 0;
+	uint64_t time = clock_now_ns();
+	int len = snprintf(line, sizeof(line), "Flight recorder: last %lu of %lu events\n",
+			end - start, end);
+	write(fd, line, len);
+	for (unsigned long i = start; i < end; ++i) {
+		const struct flight_event *event = &ring[i & (FLIGHT_RING_SIZE - 1)];
+		// Time relative to the dump, in milliseconds
+		uint64_t ago = (time - event->time) / 1000;
+		len = snprintf(line, sizeof(line), "  -%llu.%03llums %-7s %p %s\n",
+				(unsigned long long)(ago / 1000), (unsigned long long)(ago % 1000),
+				type_names[event->type], event->object, event->detail);
+		if (len >= (int)sizeof(line)) {
+			len = sizeof(line) - 1;
+			line[len - 1] = '\n';
+		}
+		write(fd, line, len);
+	}
+}
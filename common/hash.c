@@ -0,0 +1,105 @@
+#include "hash.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+// capacity is always a power of two, so the hash can be masked into an index
+static int hash_index(const hash_t *hash, uint64_t key) {
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+	return key & (hash->capacity - 1);
+}
+
+hash_t *create_hash(void) {
+	hash_t *hash = malloc(sizeof(hash_t));
+	hash->capacity = 16;
+	hash->length = 0;
+	hash->entries = calloc(hash->capacity, sizeof(struct hash_entry));
+	return hash;
+}
+
+void hash_free(hash_t *hash) {
+	if (hash == NULL) {
+		return;
+	}
+	free(hash->entries);
+	free(hash);
+}
+
+static void hash_resize(hash_t *hash) {
+	// Keep the load factor below one half so probe sequences stay short
+	if (hash->length * 2 < hash->capacity) {
+		return;
+	}
+	struct hash_entry *old = hash->entries;
+	int i, old_capacity = hash->capacity;
+	hash->capacity *= 2;
+	hash->entries = calloc(hash->capacity, sizeof(struct hash_entry));
+	for (i = 0; i < old_capacity; ++i) {
+		if (old[i].value) {
+			int j = hash_index(hash, old[i].key);
+			while (hash->entries[j].value) {
+				j = (j + 1) & (hash->capacity - 1);
+			}
+			hash->entries[j] = old[i];
+		}
+	}
+	free(old);
+}
+
+void hash_set(hash_t *hash, uint64_t key, void *value) {
+	hash_resize(hash);
+	int i = hash_index(hash, key);
+	while (hash->entries[i].value && hash->entries[i].key != key) {
+		i = (i + 1) & (hash->capacity - 1);
+	}
+	if (!hash->entries[i].value) {
+		hash->length++;
+	}
+	hash->entries[i].key = key;
+	hash->entries[i].value = value;
+}
+
+void *hash_get(hash_t *hash, uint64_t key) {
+	int i = hash_index(hash, key);
+	while (hash->entries[i].value) {
+		if (hash->entries[i].key == key) {
+			return hash->entries[i].value;
+		}
+		i = (i + 1) & (hash->capacity - 1);
+	}
+	return NULL;
+}
+
+void *hash_del(hash_t *hash, uint64_t key) {
+	int mask = hash->capacity - 1;
+	int i = hash_index(hash, key);
+	while (hash->entries[i].value && hash->entries[i].key != key) {
+		i = (i + 1) & mask;
+	}
+	void *value = hash->entries[i].value;
+	if (!value) {
+		return NULL;
+	}
+	hash->length--;
+	// Shift the following entries of the probe sequence back into the hole,
+	// so lookups never have to step over tombstones
+	int j = i;
+	while (true) {
+		j = (j + 1) & mask;
+		if (!hash->entries[j].value) {
+			break;
+		}
+		int home = hash_index(hash, hash->entries[j].key);
+		// The entry at j can fill the hole unless its home lies in (i, j]
+		bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+		if (!stays) {
+			hash->entries[i] = hash->entries[j];
+			i = j;
+		}
+	}
+	hash->entries[i].value = NULL;
+	return value;
+}
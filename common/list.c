@@ -11,28 +11,56 @@ list_t *create_list(void) {
 	return list;
 }
 
-static void list_resize(list_t *list) {
-	if (list->length == list->capacity) {
-		list->capacity += 10;
-		list->items = realloc(list->items, sizeof(void*) * list->capacity);
+// Inline lists keep their first items right after the list_t itself
+static void **inline_items(list_t *list) {
+	return (void **)(list + 1);
+}
+
+list_t *create_list_inline(int capacity) {
+	list_t *list = malloc(sizeof(list_t) + sizeof(void*) * capacity);
+	list->capacity = capacity;
+	list->length = 0;
+	list->items = inline_items(list);
+	return list;
+}
+
+// Makes room for at least count more items, doubling the capacity so adding n
+// items one at a time only reallocates O(log n) times
+static void list_reserve(list_t *list, int count) {
+	if (list->length + count <= list->capacity) {
+		return;
+	}
+	int capacity = list->capacity > 0 ? list->capacity * 2 : 4;
+	while (capacity < list->length + count) {
+		capacity *= 2;
 	}
+	if (list->items == inline_items(list)) {
+		void **items = malloc(sizeof(void*) * capacity);
+		memcpy(items, list->items, sizeof(void*) * list->length);
+		list->items = items;
+	} else {
+		list->items = realloc(list->items, sizeof(void*) * capacity);
+	}
+	list->capacity = capacity;
 }
 
 void list_free(list_t *list) {
 	if (list == NULL) {
 		return;
 	}
-	free(list->items);
+	if (list->items != inline_items(list)) {
+		free(list->items);
+	}
 	free(list);
 }
 
 void list_add(list_t *list, void *item) {
-	list_resize(list);
+	list_reserve(list, 1);
 	list->items[list->length++] = item;
 }
 
 void list_insert(list_t *list, int index, void *item) {
-	list_resize(list);
+	list_reserve(list, 1);
 	memmove(&list->items[index + 1], &list->items[index], sizeof(void*) * (list->length - index));
 	list->length++;
 	list->items[index] = item;
@@ -43,11 +71,21 @@ void list_del(list_t *list, int index) {
 	memmove(&list->items[index], &list->items[index + 1], sizeof(void*) * (list->length - index));
 }
 
+void list_remove_range(list_t *list, int index, int count) {
+	memmove(&list->items[index], &list->items[index + count],
+			sizeof(void*) * (list->length - index - count));
+	list->length -= count;
+}
+
+void list_splice(list_t *list, int index, list_t *source, int start, int count) {
+	list_reserve(list, count);
+	memmove(&list->items[index + count], &list->items[index], sizeof(void*) * (list->length - index));
+	memcpy(&list->items[index], &source->items[start], sizeof(void*) * count);
+	list->length += count;
+}
+
 void list_cat(list_t *list, list_t *source) {
-	int i;
-	for (i = 0; i < source->length; ++i) {
-		list_add(list, source->items[i]);
-	}
+	list_splice(list, list->length, source, 0, source->length);
 }
 
 // pass the pointer of the object we care about to the comparison function
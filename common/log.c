@@ -11,10 +11,14 @@
 #include <string.h>
 #include <stringop.h>
 #include <execinfo.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include "flight.h"
 
 int colored = 1;
 log_importance_t loglevel_default = L_ERROR;
-log_importance_t v = L_SILENT;
+log_importance_t loglevel = L_SILENT;
 
 static const char *verbosity_colors[] = {
 	[L_SILENT] = "",
@@ -23,28 +27,181 @@ static const char *verbosity_colors[] = {
 	[L_DEBUG ] = "\x1B[1;30m",
 };
 
+// Where records are written, stderr unless a log file was opened
+static FILE *log_file = NULL;
+
+static FILE *log_out(void) {
+	return log_file ? log_file : stderr;
+}
+
+// Number of records in the ring, a power of two
+#define LOG_RING_SIZE 1024
+// Longer lines are truncated
+#define LOG_RECORD_SIZE 512
+
+/*
+ * Formatted log lines waiting for the writer thread. Only the logging thread
+ * advances head, and only the writer advances tail. When the ring is full new
+ * records are dropped and counted rather than blocking the compositor.
+ */
+static struct {
+	char records[LOG_RING_SIZE][LOG_RECORD_SIZE];
+	unsigned int head, tail;
+	unsigned long dropped;
+	bool async;
+	sem_t wakeup;
+	pthread_t writer;
+} ring;
+
+static void *log_writer(void *data) {
+	unsigned long reported = 0;
+	while (true) {
+		if (sem_wait(&ring.wakeup) == -1) {
+			continue;
+		}
+		unsigned int tail = ring.tail;
+		unsigned int head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+		for (; tail != head; ++tail) {
+			fputs(ring.records[tail % LOG_RING_SIZE], log_out());
+			__atomic_store_n(&ring.tail, tail + 1, __ATOMIC_RELEASE);
+		}
+		unsigned long dropped = __atomic_load_n(&ring.dropped, __ATOMIC_RELAXED);
+		if (dropped != reported) {
+			fprintf(log_out(), "%lu log messages dropped\n", dropped - reported);
+			reported = dropped;
+		}
+	}
+	return NULL;
+}
+
+// Waits a bounded time for the writer thread to empty the ring
+static void log_flush(void) {
+	struct timespec delay = { 0, 1000000 };
+	int tries = 1000;
+	while (__atomic_load_n(&ring.async, __ATOMIC_ACQUIRE) && tries--
+			&& __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE) != ring.head) {
+		sem_post(&ring.wakeup);
+		nanosleep(&delay, NULL);
+	}
+}
+
+// Switches to writing records directly, writing out what is left in the ring.
+// A record the writer thread is busy with may be written twice.
+static void log_stop_async(void) {
+	if (!__atomic_exchange_n(&ring.async, false, __ATOMIC_ACQ_REL)) {
+		return;
+	}
+	unsigned int tail = __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE);
+	for (; tail != ring.head; ++tail) {
+		fputs(ring.records[tail % LOG_RING_SIZE], log_out());
+	}
+}
+
+// Forked children do not have the writer thread
+static void log_fork_child(void) {
+	ring.async = false;
+}
+
+static void log_start_async(void) {
+	if (ring.async || sem_init(&ring.wakeup, 0, 0) == -1) {
+		return;
+	}
+	if (pthread_create(&ring.writer, NULL, log_writer, NULL) != 0) {
+		sem_destroy(&ring.wakeup);
+		return;
+	}
+	ring.async = true;
+	pthread_atfork(NULL, NULL, log_fork_child);
+	atexit(log_flush);
+}
+
+// Formats a log line into record, which holds LOG_RECORD_SIZE bytes
+static void format_record(char *record, log_importance_t verbosity,
+		const char *filename, int line, const char *format, va_list args,
+		const char *error) {
+	size_t len = 0, size = LOG_RECORD_SIZE - sizeof("\x1B[0m\n");
+	bool color = colored && isatty(fileno(log_out()));
+
+	unsigned int c = verbosity;
+	if (c >= sizeof(verbosity_colors) / sizeof(char *)) {
+		c = sizeof(verbosity_colors) / sizeof(char *) - 1;
+	}
+	if (color) {
+		len += snprintf(record + len, size - len, "%s", verbosity_colors[c]);
+	}
+	if (filename && len < size) {
+		char *file = strdup(filename);
+		len += snprintf(record + len, size - len, "[%s:%d] ", basename(file), line);
+		free(file);
+	}
+	if (len < size) {
+		len += vsnprintf(record + len, size - len, format, args);
+	}
+	if (error && len < size) {
+		len += snprintf(record + len, size - len, ": %s", error);
+	}
+	if (len >= size) {
+		len = size - 1;
+	}
+	strcpy(record + len, color ? "\x1B[0m\n" : "\n");
+}
+
+static void log_record(log_importance_t verbosity, const char *filename,
+		int line, const char *format, va_list args, const char *error) {
+	if (__atomic_load_n(&ring.async, __ATOMIC_ACQUIRE)) {
+		unsigned int head = ring.head;
+		if (head - __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE) == LOG_RING_SIZE) {
+			__atomic_add_fetch(&ring.dropped, 1, __ATOMIC_RELAXED);
+			return;
+		}
+		format_record(ring.records[head % LOG_RING_SIZE], verbosity,
+				filename, line, format, args, error);
+		__atomic_store_n(&ring.head, head + 1, __ATOMIC_RELEASE);
+		sem_post(&ring.wakeup);
+	} else {
+		char record[LOG_RECORD_SIZE];
+		format_record(record, verbosity, filename, line, format, args, error);
+		fputs(record, log_out());
+	}
+}
+
 void init_log(log_importance_t verbosity) {
 	if (verbosity != L_DEBUG) {
 		// command "debuglog" needs to know the user specified log level when
 		// turning off debug logging.
 		loglevel_default = verbosity;
 	}
-	v = verbosity;
+	loglevel = verbosity;
 	signal(SIGSEGV, error_handler);
 	signal(SIGABRT, error_handler);
+	log_start_async();
+}
+
+bool set_log_file(const char *path) {
+	FILE *f = fopen(path, "a");
+	if (!f) {
+		fprintf(stderr, "Unable to open log file %s: %s, logging to stderr\n",
+				path, strerror(errno));
+		return false;
+	}
+	// Keep the file out of spawned programs, and write whole lines
+	fcntl(fileno(f), F_SETFD, FD_CLOEXEC);
+	setvbuf(f, NULL, _IOLBF, 0);
+	log_file = f;
+	return true;
 }
 
 void set_log_level(log_importance_t verbosity) {
-	v = verbosity;
+	loglevel = verbosity;
 }
 
 void reset_log_level(void) {
-	v = loglevel_default;
+	loglevel = loglevel_default;
 }
 
 bool toggle_debug_logging(void) {
-	v = (v == L_DEBUG) ? loglevel_default : L_DEBUG;
-	return (v == L_DEBUG);
+	loglevel = (loglevel == L_DEBUG) ? loglevel_default : L_DEBUG;
+	return (loglevel == L_DEBUG);
 }
 
 void sway_log_colors(int mode) {
@@ -52,12 +209,13 @@ void sway_log_colors(int mode) {
 }
 
 void sway_abort(const char *format, ...) {
-	fprintf(stderr, "ERROR: ");
+	log_stop_async();
+	fprintf(log_out(), "ERROR: ");
 	va_list args;
 	va_start(args, format);
-	vfprintf(stderr, format, args);
+	vfprintf(log_out(), format, args);
 	va_end(args);
-	fprintf(stderr, "\n");
+	fprintf(log_out(), "\n");
 	sway_terminate();
 }
 
@@ -65,57 +223,24 @@ void sway_abort(const char *format, ...) {
 void _sway_log(const char *filename, int line, log_importance_t verbosity, const char* format, ...) {
 #else
 void _sway_log(log_importance_t verbosity, const char* format, ...) {
+	const char *filename = NULL;
+	int line = 0;
 #endif
-	if (verbosity <= v) {
-		unsigned int c = verbosity;
-		if (c > sizeof(verbosity_colors) / sizeof(char *)) {
-			c = sizeof(verbosity_colors) / sizeof(char *) - 1;
-		}
-
-		if (colored && isatty(STDERR_FILENO)) {
-			fprintf(stderr, "%s", verbosity_colors[c]);
-		}
-
+	if (verbosity <= loglevel) {
 		va_list args;
 		va_start(args, format);
-#ifndef NDEBUG
-		char *file = strdup(filename);
-		fprintf(stderr, "[%s:%d] ", basename(file), line);
-		free(file);
-#endif
-		vfprintf(stderr, format, args);
+		log_record(verbosity, filename, line, format, args, NULL);
 		va_end(args);
-
-		if (colored && isatty(STDERR_FILENO)) {
-			fprintf(stderr, "\x1B[0m");
-		}
-		fprintf(stderr, "\n");
 	}
 }
 
 void sway_log_errno(log_importance_t verbosity, char* format, ...) {
-	if (verbosity <= v) {
-		unsigned int c = verbosity;
-		if (c > sizeof(verbosity_colors) / sizeof(char *)) {
-			c = sizeof(verbosity_colors) / sizeof(char *) - 1;
-		}
-
-		if (colored && isatty(STDERR_FILENO)) {
-			fprintf(stderr, "%s", verbosity_colors[c]);
-		}
-
+	if (verbosity <= loglevel) {
+		const char *error = strerror(errno);
 		va_list args;
 		va_start(args, format);
-		vfprintf(stderr, format, args);
+		log_record(verbosity, NULL, 0, format, args, error);
 		va_end(args);
-
-		fprintf(stderr, ": ");
-		fprintf(stderr, "%s", strerror(errno));
-
-		if (colored && isatty(STDERR_FILENO)) {
-			fprintf(stderr, "\x1B[0m");
-		}
-		fprintf(stderr, "\n");
 	}
 }
 
@@ -143,12 +268,15 @@ void error_handler(int sig) {
 	char **bt;
 	size_t bt_len;
 
+	log_stop_async();
+	fflush(log_out());
+	flight_dump(fileno(log_out()));
 	sway_log(L_ERROR, "Error: Signal %d. Printing backtrace", sig);
 	bt_len = backtrace(array, max_lines);
 	bt = backtrace_symbols(array, bt_len);
 	if (!bt) {
 		sway_log(L_ERROR, "Could not allocate sufficient memory for backtrace_symbols(), falling back to stderr");
-		backtrace_symbols_fd(array, bt_len, STDERR_FILENO);
+		backtrace_symbols_fd(array, bt_len, fileno(log_out()));
 		exit(1);
 	}
 
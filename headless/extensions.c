@@ -0,0 +1,9 @@
+#include "extensions.h"
+
+// There is no Wayland display to put the desktop shell global on, so no
+// client can set a background
+struct desktop_shell_state desktop_shell;
+
+void register_extensions(void) {
+	desktop_shell.backgrounds = create_list();
+}
@@ -0,0 +1,85 @@
+#ifndef _HEADLESS_H
+#define _HEADLESS_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <wlc/wlc.h>
+
+/**
+ * Drives the headless wlc. Events are passed to the callbacks given to
+ * wlc_init right away, as wlc would when the hardware or a client reports
+ * them.
+ */
+
+/**
+ * Creates an output and passes it to the output created callback. Returns
+ * the new handle, or 0 if the callback rejected the output.
+ */
+wlc_handle headless_output_create(const char *name, uint32_t width, uint32_t height);
+void headless_output_destroy(wlc_handle output);
+// Calls the pre render callback, where sway runs pending arranges
+void headless_output_render(wlc_handle output);
+
+/**
+ * What a client tells wlc about a new view. All but output may be left zero.
+ */
+struct headless_view {
+	wlc_handle output;
+	wlc_handle parent;
+	uint32_t type;
+	struct wlc_geometry geometry;
+	const char *title;
+	const char *class;
+	const char *app_id;
+};
+
+/**
+ * Creates a view and passes it to the view created callback. Returns the
+ * new handle, or 0 if the callback rejected the view.
+ */
+wlc_handle headless_view_create(const struct headless_view *view);
+void headless_view_destroy(wlc_handle view);
+void headless_view_request_geometry(wlc_handle view, const struct wlc_geometry *geometry);
+void headless_view_request_state(wlc_handle view, enum wlc_view_state_bit state, bool toggle);
+// Whether the compositor asked the view to close with wlc_view_close
+bool headless_view_close_requested(wlc_handle view);
+
+/**
+ * Input goes to the focused view. Returns what the callback returned, true
+ * if the compositor kept the event from the client.
+ */
+bool headless_key(uint32_t key, uint32_t mods, enum wlc_key_state state);
+bool headless_pointer_motion(int32_t x, int32_t y);
+// Pressed at the current pointer position
+bool headless_pointer_button(uint32_t button, uint32_t mods, enum wlc_button_state state);
+
+/**
+ * Waits up to timeout milliseconds, or forever if it is negative, for the
+ * file descriptors added with wlc_event_loop_add_fd, and calls back those that
+ * are ready. For running the event loop step by step instead of with
+ * wlc_run. Returns the number of callbacks made, or -1 if polling failed.
+ */
+int headless_dispatch(int timeout);
+
+enum headless_call_type {
+	HEADLESS_SET_GEOMETRY,
+	HEADLESS_SET_MASK,
+};
+
+/**
+ * A wlc_view_set_geometry or wlc_view_set_mask call made by the compositor.
+ */
+struct headless_call {
+	enum headless_call_type type;
+	wlc_handle view;
+	struct wlc_geometry geometry;
+	uint32_t mask;
+};
+
+/**
+ * Returns the calls recorded since the last headless_clear_calls, oldest
+ * first. The array is valid until the next call into wlc.
+ */
+const struct headless_call *headless_get_calls(size_t *count);
+void headless_clear_calls(void);
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef _HEADLESS_WLC_WAYLAND_H
+#define _HEADLESS_WLC_WAYLAND_H
+#include <wlc/wlc.h>
+
+/**
+ * There are no Wayland clients, so no resources ever map to wlc handles.
+ */
+
+struct wl_display;
+struct wl_resource;
+
+struct wl_display *wlc_get_wl_display(void);
+wlc_handle wlc_handle_from_wl_output_resource(const struct wl_resource *resource);
+wlc_resource wlc_resource_from_wl_surface_resource(struct wl_resource *resource);
+void wlc_surface_render(wlc_resource surface, const struct wlc_geometry *geometry);
+
+#endif
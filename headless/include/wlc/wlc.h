@@ -0,0 +1,248 @@
+#ifndef _HEADLESS_WLC_H
+#define _HEADLESS_WLC_H
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/**
+ * The part of the wlc API that sway uses, implemented without a display,
+ * input devices or clients. See headless.h for driving it.
+ */
+
+typedef uintptr_t wlc_handle;
+typedef uintptr_t wlc_resource;
+
+struct wlc_event_source;
+
+enum wlc_log_type {
+	WLC_LOG_INFO,
+	WLC_LOG_WARN,
+	WLC_LOG_ERROR,
+	WLC_LOG_WAYLAND,
+};
+
+enum wlc_event_bit {
+	WLC_EVENT_READABLE = 0x01,
+	WLC_EVENT_WRITABLE = 0x02,
+	WLC_EVENT_HANGUP = 0x04,
+	WLC_EVENT_ERROR = 0x08,
+};
+
+enum wlc_view_state_bit {
+	WLC_BIT_MAXIMIZED = 1<<0,
+	WLC_BIT_FULLSCREEN = 1<<1,
+	WLC_BIT_RESIZING = 1<<2,
+	WLC_BIT_MOVING = 1<<3,
+	WLC_BIT_ACTIVATED = 1<<4,
+};
+
+enum wlc_view_type_bit {
+	WLC_BIT_OVERRIDE_REDIRECT = 1<<0,
+	WLC_BIT_UNMANAGED = 1<<1,
+	WLC_BIT_SPLASH = 1<<2,
+	WLC_BIT_MODAL = 1<<3,
+	WLC_BIT_POPUP = 1<<4,
+};
+
+enum wlc_resize_edge {
+	WLC_RESIZE_EDGE_NONE = 0,
+	WLC_RESIZE_EDGE_TOP = 1,
+	WLC_RESIZE_EDGE_BOTTOM = 2,
+	WLC_RESIZE_EDGE_LEFT = 4,
+	WLC_RESIZE_EDGE_TOP_LEFT = 5,
+	WLC_RESIZE_EDGE_BOTTOM_LEFT = 6,
+	WLC_RESIZE_EDGE_RIGHT = 8,
+	WLC_RESIZE_EDGE_TOP_RIGHT = 9,
+	WLC_RESIZE_EDGE_BOTTOM_RIGHT = 10,
+};
+
+enum wlc_modifier_bit {
+	WLC_BIT_MOD_SHIFT = 1<<0,
+	WLC_BIT_MOD_CAPS = 1<<1,
+	WLC_BIT_MOD_CTRL = 1<<2,
+	WLC_BIT_MOD_ALT = 1<<3,
+	WLC_BIT_MOD_MOD2 = 1<<4,
+	WLC_BIT_MOD_MOD3 = 1<<5,
+	WLC_BIT_MOD_LOGO = 1<<6,
+	WLC_BIT_MOD_MOD5 = 1<<7,
+};
+
+enum wlc_led_bit {
+	WLC_BIT_LED_NUM = 1<<0,
+	WLC_BIT_LED_CAPS = 1<<1,
+	WLC_BIT_LED_SCROLL = 1<<2,
+};
+
+enum wlc_key_state {
+	WLC_KEY_STATE_RELEASED = 0,
+	WLC_KEY_STATE_PRESSED = 1,
+};
+
+enum wlc_button_state {
+	WLC_BUTTON_STATE_RELEASED = 0,
+	WLC_BUTTON_STATE_PRESSED = 1,
+};
+
+enum wlc_scroll_axis_bit {
+	WLC_SCROLL_AXIS_VERTICAL = 1<<0,
+	WLC_SCROLL_AXIS_HORIZONTAL = 1<<1,
+};
+
+struct wlc_modifiers {
+	uint32_t leds, mods;
+};
+
+struct wlc_point {
+	int32_t x, y;
+};
+
+struct wlc_size {
+	uint32_t w, h;
+};
+
+struct wlc_geometry {
+	struct wlc_point origin;
+	struct wlc_size size;
+};
+
+extern const struct wlc_point wlc_point_zero;
+extern const struct wlc_size wlc_size_zero;
+
+// Older names, still used by sway
+#define wlc_origin wlc_point
+#define wlc_origin_zero wlc_point_zero
+
+static inline bool wlc_point_equals(const struct wlc_point *a, const struct wlc_point *b) {
+	return a->x == b->x && a->y == b->y;
+}
+
+static inline bool wlc_size_equals(const struct wlc_size *a, const struct wlc_size *b) {
+	return a->w == b->w && a->h == b->h;
+}
+
+static inline bool wlc_geometry_equals(const struct wlc_geometry *a, const struct wlc_geometry *b) {
+	return wlc_point_equals(&a->origin, &b->origin) && wlc_size_equals(&a->size, &b->size);
+}
+
+struct wlc_interface {
+	struct {
+		bool (*created)(wlc_handle output);
+		void (*destroyed)(wlc_handle output);
+		void (*focus)(wlc_handle output, bool focus);
+		void (*resolution)(wlc_handle output, const struct wlc_size *from, const struct wlc_size *to);
+		struct {
+			void (*pre)(wlc_handle output);
+			void (*post)(wlc_handle output);
+		} render;
+	} output;
+
+	struct {
+		bool (*created)(wlc_handle view);
+		void (*destroyed)(wlc_handle view);
+		void (*focus)(wlc_handle view, bool focus);
+		void (*move_to_output)(wlc_handle view, wlc_handle from_output, wlc_handle to_output);
+		struct {
+			void (*geometry)(wlc_handle view, const struct wlc_geometry *geometry);
+			void (*state)(wlc_handle view, enum wlc_view_state_bit state, bool toggle);
+		} request;
+	} view;
+
+	struct {
+		bool (*key)(wlc_handle view, uint32_t time, const struct wlc_modifiers *modifiers,
+				uint32_t key, enum wlc_key_state state);
+	} keyboard;
+
+	struct {
+		bool (*button)(wlc_handle view, uint32_t time, const struct wlc_modifiers *modifiers,
+				uint32_t button, enum wlc_button_state state, const struct wlc_point *position);
+		bool (*scroll)(wlc_handle view, uint32_t time, const struct wlc_modifiers *modifiers,
+				uint8_t axis_bits, double amount[2]);
+		bool (*motion)(wlc_handle view, uint32_t time, const struct wlc_point *position);
+	} pointer;
+
+	struct {
+		void (*ready)(void);
+	} compositor;
+};
+
+/** Core */
+
+void wlc_log_set_handler(void (*cb)(enum wlc_log_type type, const char *str));
+/**
+ * Only keeps the interface, there is no display to set up.
+ */
+bool wlc_init(const struct wlc_interface *interface, int argc, char *argv[]);
+/**
+ * Calls the ready callback, then waits on the file descriptors added with
+ * wlc_event_loop_add_fd until wlc_terminate is called.
+ */
+void wlc_run(void);
+void wlc_terminate(void);
+
+struct wlc_event_source *wlc_event_loop_add_fd(int fd, uint32_t mask,
+		int (*cb)(int fd, uint32_t mask, void *arg), void *arg);
+void wlc_event_source_remove(struct wlc_event_source *source);
+
+/** Outputs */
+
+wlc_handle wlc_get_focused_output(void);
+/**
+ * Calls the output focus callbacks if the focused output changes.
+ */
+void wlc_output_focus(wlc_handle output);
+const char *wlc_output_get_name(wlc_handle output);
+const struct wlc_size *wlc_output_get_resolution(wlc_handle output);
+/**
+ * Calls the output resolution callback if the resolution changes.
+ */
+void wlc_output_set_resolution(wlc_handle output, const struct wlc_size *resolution);
+uint32_t wlc_output_get_mask(wlc_handle output);
+void wlc_output_set_mask(wlc_handle output, uint32_t mask);
+/**
+ * Passes a zeroed buffer the size of the output to pixels, right away.
+ */
+void wlc_output_get_pixels(wlc_handle output,
+		bool (*pixels)(const struct wlc_size *size, uint8_t *rgba, void *arg), void *arg);
+
+/** Views */
+
+/**
+ * Calls the view focus callbacks if the focused view changes.
+ */
+void wlc_view_focus(wlc_handle view);
+/**
+ * Only marks the view as asked to close, it is destroyed when the test says
+ * so with headless_view_destroy.
+ */
+void wlc_view_close(wlc_handle view);
+wlc_handle wlc_view_get_output(wlc_handle view);
+void wlc_view_set_output(wlc_handle view, wlc_handle output);
+void wlc_view_send_to_back(wlc_handle view);
+void wlc_view_send_below(wlc_handle view, wlc_handle other);
+void wlc_view_bring_above(wlc_handle view, wlc_handle other);
+void wlc_view_bring_to_front(wlc_handle view);
+uint32_t wlc_view_get_mask(wlc_handle view);
+void wlc_view_set_mask(wlc_handle view, uint32_t mask);
+const struct wlc_geometry *wlc_view_get_geometry(wlc_handle view);
+void wlc_view_set_geometry(wlc_handle view, uint32_t edges, const struct wlc_geometry *geometry);
+uint32_t wlc_view_get_type(wlc_handle view);
+void wlc_view_set_type(wlc_handle view, enum wlc_view_type_bit type, bool toggle);
+uint32_t wlc_view_get_state(wlc_handle view);
+void wlc_view_set_state(wlc_handle view, enum wlc_view_state_bit state, bool toggle);
+wlc_handle wlc_view_get_parent(wlc_handle view);
+void wlc_view_set_parent(wlc_handle view, wlc_handle parent);
+const char *wlc_view_get_title(wlc_handle view);
+const char *wlc_view_get_class(wlc_handle view);
+const char *wlc_view_get_app_id(wlc_handle view);
+
+/** Input */
+
+/**
+ * There is no keymap, key codes are their own keysyms.
+ */
+uint32_t wlc_keyboard_get_keysym_for_key(uint32_t key, const struct wlc_modifiers *modifiers);
+void wlc_pointer_get_position(struct wlc_point *out_position);
+void wlc_pointer_set_position(const struct wlc_point *position);
+
+#endif
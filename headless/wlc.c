@@ -0,0 +1,588 @@
+#include <errno.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wlc/wlc.h>
+#include <wlc/wlc-wayland.h>
+#include "headless.h"
+
+enum handle_kind {
+	HANDLE_FREE,
+	HANDLE_OUTPUT,
+	HANDLE_VIEW,
+};
+
+struct handle {
+	enum handle_kind kind;
+	// Output name or view title
+	char *name;
+	char *class;
+	char *app_id;
+	struct wlc_size resolution;
+	struct wlc_geometry geometry;
+	uint32_t mask;
+	uint32_t type;
+	uint32_t state;
+	wlc_handle output;
+	wlc_handle parent;
+	bool close_requested;
+	// Next free slot while this one is free, as an index plus one
+	size_t next_free;
+};
+
+struct wlc_event_source {
+	int fd;
+	uint32_t mask;
+	int (*cb)(int fd, uint32_t mask, void *arg);
+	void *arg;
+	// Removed sources are freed by the event loop, which may be using them
+	bool removed;
+	struct wlc_event_source *next;
+};
+
+const struct wlc_point wlc_point_zero = { 0, 0 };
+const struct wlc_size wlc_size_zero = { 0, 0 };
+
+static const struct wlc_interface *interface = NULL;
+static void (*log_handler)(enum wlc_log_type type, const char *str) = NULL;
+
+// Handles are their index plus one, so 0 is never a valid handle
+static struct handle *handles = NULL;
+static size_t handles_length = 0, handles_capacity = 0;
+static size_t first_free = 0;
+
+static wlc_handle focused_output = 0, focused_view = 0;
+static struct wlc_point pointer = { 0, 0 };
+static uint32_t event_time = 0;
+
+static struct headless_call *calls = NULL;
+static size_t calls_length = 0, calls_capacity = 0;
+
+static struct wlc_event_source *sources = NULL;
+static bool running = false, dispatching = false;
+
+static void wlc_log(enum wlc_log_type type, const char *format, ...) {
+	if (!log_handler) {
+		return;
+	}
+	char buf[256];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(buf, sizeof(buf), format, args);
+	va_end(args);
+	log_handler(type, buf);
+}
+
+static void *grow(void *array, size_t *capacity, size_t size) {
+	size_t new_capacity = *capacity ? *capacity * 2 : 64;
+	void *new_array = realloc(array, new_capacity * size);
+	if (!new_array) {
+		fprintf(stderr, "headless wlc: out of memory\n");
+		abort();
+	}
+	*capacity = new_capacity;
+	return new_array;
+}
+
+static struct handle *get_handle(wlc_handle handle, enum handle_kind kind) {
+	if (handle == 0 || handle > handles_length || handles[handle - 1].kind != kind) {
+		return NULL;
+	}
+	return &handles[handle - 1];
+}
+
+static wlc_handle new_handle(enum handle_kind kind) {
+	size_t i;
+	if (first_free) {
+		i = first_free - 1;
+		first_free = handles[i].next_free;
+	} else {
+		if (handles_length == handles_capacity) {
+			handles = grow(handles, &handles_capacity, sizeof(struct handle));
+		}
+		i = handles_length++;
+	}
+	memset(&handles[i], 0, sizeof(struct handle));
+	handles[i].kind = kind;
+	return i + 1;
+}
+
+static void free_handle(wlc_handle handle) {
+	struct handle *h = &handles[handle - 1];
+	free(h->name);
+	free(h->class);
+	free(h->app_id);
+	h->kind = HANDLE_FREE;
+	h->next_free = first_free;
+	first_free = handle;
+}
+
+static char *copy_string(const char *str) {
+	return str ? strdup(str) : NULL;
+}
+
+static void record_call(const struct headless_call *call) {
+	if (calls_length == calls_capacity) {
+		calls = grow(calls, &calls_capacity, sizeof(struct headless_call));
+	}
+	calls[calls_length++] = *call;
+}
+
+// Core
+
+void wlc_log_set_handler(void (*cb)(enum wlc_log_type type, const char *str)) {
+	log_handler = cb;
+}
+
+bool wlc_init(const struct wlc_interface *_interface, int argc, char *argv[]) {
+	interface = _interface;
+	wlc_log(WLC_LOG_INFO, "Running headless, without a display");
+	return true;
+}
+
+static void remove_sources(void) {
+	struct wlc_event_source **link = &sources;
+	while (*link) {
+		struct wlc_event_source *source = *link;
+		if (source->removed) {
+			*link = source->next;
+			free(source);
+		} else {
+			link = &source->next;
+		}
+	}
+}
+
+void wlc_run(void) {
+	if (interface->compositor.ready) {
+		interface->compositor.ready();
+	}
+	running = true;
+	while (running && headless_dispatch(-1) != -1);
+	running = false;
+	remove_sources();
+}
+
+void wlc_terminate(void) {
+	running = false;
+}
+
+struct wlc_event_source *wlc_event_loop_add_fd(int fd, uint32_t mask,
+		int (*cb)(int fd, uint32_t mask, void *arg), void *arg) {
+	struct wlc_event_source *source = calloc(1, sizeof(struct wlc_event_source));
+	if (!source) {
+		return NULL;
+	}
+	source->fd = fd;
+	source->mask = mask;
+	source->cb = cb;
+	source->arg = arg;
+	source->next = sources;
+	sources = source;
+	return source;
+}
+
+void wlc_event_source_remove(struct wlc_event_source *source) {
+	source->removed = true;
+	if (!dispatching) {
+		remove_sources();
+	}
+}
+
+// Outputs
+
+wlc_handle wlc_get_focused_output(void) {
+	return focused_output;
+}
+
+void wlc_output_focus(wlc_handle output) {
+	if (output == focused_output || (output && !get_handle(output, HANDLE_OUTPUT))) {
+		return;
+	}
+	wlc_handle old = focused_output;
+	focused_output = output;
+	if (interface->output.focus) {
+		if (old) {
+			interface->output.focus(old, false);
+		}
+		if (output) {
+			interface->output.focus(output, true);
+		}
+	}
+}
+
+const char *wlc_output_get_name(wlc_handle output) {
+	struct handle *h = get_handle(output, HANDLE_OUTPUT);
+	return h ? h->name : NULL;
+}
+
+const struct wlc_size *wlc_output_get_resolution(wlc_handle output) {
+	struct handle *h = get_handle(output, HANDLE_OUTPUT);
+	return h ? &h->resolution : &wlc_size_zero;
+}
+
+void wlc_output_set_resolution(wlc_handle output, const struct wlc_size *resolution) {
+	struct handle *h = get_handle(output, HANDLE_OUTPUT);
+	if (!h || wlc_size_equals(&h->resolution, resolution)) {
+		return;
+	}
+	struct wlc_size from = h->resolution;
+	h->resolution = *resolution;
+	if (interface->output.resolution) {
+		interface->output.resolution(output, &from, resolution);
+	}
+}
+
+uint32_t wlc_output_get_mask(wlc_handle output) {
+	struct handle *h = get_handle(output, HANDLE_OUTPUT);
+	return h ? h->mask : 0;
+}
+
+void wlc_output_set_mask(wlc_handle output, uint32_t mask) {
+	struct handle *h = get_handle(output, HANDLE_OUTPUT);
+	if (h) {
+		h->mask = mask;
+	}
+}
+
+void wlc_output_get_pixels(wlc_handle output,
+		bool (*pixels)(const struct wlc_size *size, uint8_t *rgba, void *arg), void *arg) {
+	struct handle *h = get_handle(output, HANDLE_OUTPUT);
+	if (!h) {
+		return;
+	}
+	uint8_t *rgba = calloc((size_t)h->resolution.w * h->resolution.h, 4);
+	if (rgba) {
+		pixels(&h->resolution, rgba, arg);
+		free(rgba);
+	}
+}
+
+// Views
+
+void wlc_view_focus(wlc_handle view) {
+	if (view == focused_view || (view && !get_handle(view, HANDLE_VIEW))) {
+		return;
+	}
+	wlc_handle old = focused_view;
+	focused_view = view;
+	if (interface->view.focus) {
+		if (old) {
+			interface->view.focus(old, false);
+		}
+		if (view) {
+			interface->view.focus(view, true);
+		}
+	}
+}
+
+void wlc_view_close(wlc_handle view) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	if (h) {
+		h->close_requested = true;
+	}
+}
+
+wlc_handle wlc_view_get_output(wlc_handle view) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	return h ? h->output : 0;
+}
+
+void wlc_view_set_output(wlc_handle view, wlc_handle output) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	if (!h || h->output == output) {
+		return;
+	}
+	wlc_handle from = h->output;
+	h->output = output;
+	if (interface->view.move_to_output) {
+		interface->view.move_to_output(view, from, output);
+	}
+}
+
+// Nothing is drawn, so stacking order isn't kept
+void wlc_view_send_to_back(wlc_handle view) {
+}
+
+void wlc_view_send_below(wlc_handle view, wlc_handle other) {
+}
+
+void wlc_view_bring_above(wlc_handle view, wlc_handle other) {
+}
+
+void wlc_view_bring_to_front(wlc_handle view) {
+}
+
+uint32_t wlc_view_get_mask(wlc_handle view) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	return h ? h->mask : 0;
+}
+
+void wlc_view_set_mask(wlc_handle view, uint32_t mask) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	if (!h) {
+		return;
+	}
+	h->mask = mask;
+	record_call(&(struct headless_call){ .type = HEADLESS_SET_MASK, .view = view, .mask = mask });
+}
+
+const struct wlc_geometry *wlc_view_get_geometry(wlc_handle view) {
+	static const struct wlc_geometry none = { { 0, 0 }, { 0, 0 } };
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	return h ? &h->geometry : &none;
+}
+
+void wlc_view_set_geometry(wlc_handle view, uint32_t edges, const struct wlc_geometry *geometry) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	if (!h) {
+		return;
+	}
+	h->geometry = *geometry;
+	record_call(&(struct headless_call){ .type = HEADLESS_SET_GEOMETRY, .view = view, .geometry = *geometry });
+}
+
+uint32_t wlc_view_get_type(wlc_handle view) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	return h ? h->type : 0;
+}
+
+void wlc_view_set_type(wlc_handle view, enum wlc_view_type_bit type, bool toggle) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	if (h) {
+		h->type = toggle ? h->type | type : h->type & ~type;
+	}
+}
+
+uint32_t wlc_view_get_state(wlc_handle view) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	return h ? h->state : 0;
+}
+
+void wlc_view_set_state(wlc_handle view, enum wlc_view_state_bit state, bool toggle) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	if (h) {
+		h->state = toggle ? h->state | state : h->state & ~state;
+	}
+}
+
+wlc_handle wlc_view_get_parent(wlc_handle view) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	return h ? h->parent : 0;
+}
+
+void wlc_view_set_parent(wlc_handle view, wlc_handle parent) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	if (h) {
+		h->parent = parent;
+	}
+}
+
+const char *wlc_view_get_title(wlc_handle view) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	return h ? h->name : NULL;
+}
+
+const char *wlc_view_get_class(wlc_handle view) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	return h ? h->class : NULL;
+}
+
+const char *wlc_view_get_app_id(wlc_handle view) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	return h ? h->app_id : NULL;
+}
+
+// Input
+
+uint32_t wlc_keyboard_get_keysym_for_key(uint32_t key, const struct wlc_modifiers *modifiers) {
+	return key;
+}
+
+void wlc_pointer_get_position(struct wlc_point *out_position) {
+	*out_position = pointer;
+}
+
+void wlc_pointer_set_position(const struct wlc_point *position) {
+	pointer = *position;
+}
+
+// Wayland
+
+struct wl_display *wlc_get_wl_display(void) {
+	return NULL;
+}
+
+wlc_handle wlc_handle_from_wl_output_resource(const struct wl_resource *resource) {
+	return 0;
+}
+
+wlc_resource wlc_resource_from_wl_surface_resource(struct wl_resource *resource) {
+	return 0;
+}
+
+void wlc_surface_render(wlc_resource surface, const struct wlc_geometry *geometry) {
+}
+
+// Test driver
+
+wlc_handle headless_output_create(const char *name, uint32_t width, uint32_t height) {
+	wlc_handle output = new_handle(HANDLE_OUTPUT);
+	struct handle *h = &handles[output - 1];
+	h->name = copy_string(name);
+	h->resolution = (struct wlc_size){ width, height };
+	if (interface->output.created && !interface->output.created(output)) {
+		free_handle(output);
+		return 0;
+	}
+	if (!focused_output) {
+		wlc_output_focus(output);
+	}
+	return output;
+}
+
+void headless_output_destroy(wlc_handle output) {
+	if (!get_handle(output, HANDLE_OUTPUT)) {
+		return;
+	}
+	if (focused_output == output) {
+		focused_output = 0;
+	}
+	if (interface->output.destroyed) {
+		interface->output.destroyed(output);
+	}
+	free_handle(output);
+}
+
+void headless_output_render(wlc_handle output) {
+	if (get_handle(output, HANDLE_OUTPUT) && interface->output.render.pre) {
+		interface->output.render.pre(output);
+	}
+}
+
+wlc_handle headless_view_create(const struct headless_view *view) {
+	wlc_handle handle = new_handle(HANDLE_VIEW);
+	struct handle *h = &handles[handle - 1];
+	h->name = copy_string(view->title);
+	h->class = copy_string(view->class);
+	h->app_id = copy_string(view->app_id);
+	h->output = view->output;
+	h->parent = view->parent;
+	h->type = view->type;
+	h->geometry = view->geometry;
+	if (interface->view.created && !interface->view.created(handle)) {
+		free_handle(handle);
+		return 0;
+	}
+	return handle;
+}
+
+void headless_view_destroy(wlc_handle view) {
+	if (!get_handle(view, HANDLE_VIEW)) {
+		return;
+	}
+	if (focused_view == view) {
+		focused_view = 0;
+	}
+	if (interface->view.destroyed) {
+		interface->view.destroyed(view);
+	}
+	free_handle(view);
+}
+
+void headless_view_request_geometry(wlc_handle view, const struct wlc_geometry *geometry) {
+	if (get_handle(view, HANDLE_VIEW) && interface->view.request.geometry) {
+		interface->view.request.geometry(view, geometry);
+	}
+}
+
+void headless_view_request_state(wlc_handle view, enum wlc_view_state_bit state, bool toggle) {
+	if (get_handle(view, HANDLE_VIEW) && interface->view.request.state) {
+		interface->view.request.state(view, state, toggle);
+	}
+}
+
+bool headless_view_close_requested(wlc_handle view) {
+	struct handle *h = get_handle(view, HANDLE_VIEW);
+	return h && h->close_requested;
+}
+
+int headless_dispatch(int timeout) {
+	remove_sources();
+	size_t i, length = 0;
+	struct wlc_event_source *source;
+	for (source = sources; source; source = source->next) {
+		++length;
+	}
+	struct pollfd *fds = calloc(length ? length : 1, sizeof(struct pollfd));
+	struct wlc_event_source **polled = calloc(length ? length : 1, sizeof(*polled));
+	for (i = 0, source = sources; source; source = source->next, ++i) {
+		fds[i].fd = source->fd;
+		fds[i].events = (source->mask & WLC_EVENT_READABLE ? POLLIN : 0)
+			| (source->mask & WLC_EVENT_WRITABLE ? POLLOUT : 0);
+		polled[i] = source;
+	}
+	int dispatched = 0;
+	if (poll(fds, length, timeout) == -1) {
+		if (errno != EINTR) {
+			wlc_log(WLC_LOG_ERROR, "poll failed: %s", strerror(errno));
+			dispatched = -1;
+		}
+		length = 0;
+	}
+	// Sources removed by a callback are only freed once all are dispatched
+	dispatching = true;
+	for (i = 0; i < length; ++i) {
+		source = polled[i];
+		if (!fds[i].revents || source->removed) {
+			continue;
+		}
+		uint32_t mask = (fds[i].revents & POLLIN ? WLC_EVENT_READABLE : 0)
+			| (fds[i].revents & POLLOUT ? WLC_EVENT_WRITABLE : 0)
+			| (fds[i].revents & POLLHUP ? WLC_EVENT_HANGUP : 0)
+			| (fds[i].revents & (POLLERR | POLLNVAL) ? WLC_EVENT_ERROR : 0);
+		source->cb(source->fd, mask, source->arg);
+		++dispatched;
+	}
+	dispatching = false;
+	free(fds);
+	free(polled);
+	return dispatched;
+}
+
+bool headless_key(uint32_t key, uint32_t mods, enum wlc_key_state state) {
+	if (!interface->keyboard.key) {
+		return false;
+	}
+	struct wlc_modifiers modifiers = { 0, mods };
+	return interface->keyboard.key(focused_view, ++event_time, &modifiers, key, state);
+}
+
+bool headless_pointer_motion(int32_t x, int32_t y) {
+	if (!interface->pointer.motion) {
+		return false;
+	}
+	struct wlc_point position = { x, y };
+	return interface->pointer.motion(focused_view, ++event_time, &position);
+}
+
+bool headless_pointer_button(uint32_t button, uint32_t mods, enum wlc_button_state state) {
+	if (!interface->pointer.button) {
+		return false;
+	}
+	struct wlc_modifiers modifiers = { 0, mods };
+	struct wlc_point position = pointer;
+	return interface->pointer.button(focused_view, ++event_time, &modifiers,
+			button, state, &position);
+}
+
+const struct headless_call *headless_get_calls(size_t *count) {
+	*count = calls_length;
+	return calls;
+}
+
+void headless_clear_calls(void) {
+	calls_length = 0;
+}
@@ -0,0 +1,11 @@
+#ifndef _SWAY_CLOCK_H
+#define _SWAY_CLOCK_H
+#include <stdint.h>
+
+/**
+ * Returns the current time of the monotonic clock in nanoseconds, for timing
+ * intervals. Doesn't allocate, so it is safe in signal handlers.
+ */
+uint64_t clock_now_ns(void);
+
+#endif
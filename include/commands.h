@@ -34,6 +34,25 @@ struct cmd_results {
  * Parse and handles a command.
  */
 struct cmd_results *handle_command(char *command);
+/**
+ * A list of commands parsed ahead of time, to be run with
+ * handle_compiled_command.
+ */
+struct cmd_list;
+/**
+ * Parses a command for repeated execution. Returns NULL if it can not be
+ * compiled, in which case it should be run with handle_command, which reports
+ * the error.
+ */
+struct cmd_list *compile_command(const char *command);
+/**
+ * Handles a compiled command, like handle_command.
+ */
+struct cmd_results *handle_compiled_command(struct cmd_list *list);
+/**
+ * Frees a compiled command. It is only freed once it is no longer running.
+ */
+void free_cmd_list(struct cmd_list *list);
 /**
  * Parse and handles a command during config file loading.
  *
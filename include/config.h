@@ -23,6 +23,7 @@ struct sway_binding {
 	list_t *keys;
 	uint32_t modifiers;
 	char *command;
+	struct cmd_list *compiled;
 };
 
 /**
@@ -31,6 +32,16 @@ struct sway_binding {
 struct sway_mode {
 	char *name;
 	list_t *bindings;
+	/**
+	 * Built from bindings by compile_mode_bindings, NULL until then.
+	 * key_bindings maps (modifiers << 32 | keysym) to single key bindings,
+	 * chord_bindings holds bindings of several keys in bindings order.
+	 * workspace_names holds the workspaces bound with `workspace <name>`,
+	 * without duplicates and in bindings order.
+	 */
+	hash_t *key_bindings;
+	list_t *chord_bindings;
+	list_t *workspace_names;
 };
 
 /**
@@ -108,6 +119,23 @@ int sway_binding_cmp(const void *a, const void *b);
 int sway_binding_cmp_keys(const void *a, const void *b);
 void free_sway_binding(struct sway_binding *sb);
 
+/**
+ * Builds the lookup structures used to match the bindings of a mode against
+ * the pressed keys.
+ */
+void compile_mode_bindings(struct sway_mode *mode);
+/**
+ * Frees the lookup structures of a mode, to be rebuilt once it is used again.
+ * Must be called whenever the bindings of the mode change.
+ */
+void free_mode_bindings_index(struct sway_mode *mode);
+/**
+ * Returns the binding of mode matching the pressed keys and the given
+ * modifiers, or NULL. Bindings of more keys take precedence, as with the order
+ * given by sway_binding_cmp_keys.
+ */
+struct sway_binding *get_pressed_binding(struct sway_mode *mode, uint32_t modifiers);
+
 /**
  * Global config singleton.
  */
@@ -3,6 +3,8 @@
 #include <wlc/wlc.h>
 typedef struct sway_container swayc_t;
 
+#include "hash.h"
+
 #include "layout.h"
 
 /**
@@ -67,6 +69,12 @@ struct sway_container {
 	 */
 	double x, y;
 
+	/**
+	 * The geometry last sent to this view's client, so that unchanged
+	 * geometry is not sent again.
+	 */
+	struct wlc_geometry sent_geometry;
+
 	/**
 	 * False if this view is invisible. It could be in the scratchpad or on a
 	 * workspace that is not shown.
@@ -88,6 +96,12 @@ struct sway_container {
 	 */
 	list_t *floating;
 
+	/**
+	 * Position of this container in its parent's children (or floating, if
+	 * floating) list. Kept up to date by the list operations in layout.c.
+	 */
+	int index;
+
 	/**
 	 * The parent of this container. NULL for the root container.
 	 */
@@ -96,11 +110,56 @@ struct sway_container {
 	 * Which of this container's children has focus.
 	 */
 	struct sway_container *focused;
+	/**
+	 * Set when this container needs to be laid out again on the next arrange,
+	 * even if its geometry is unchanged.
+	 */
+	bool dirty;
+	/**
+	 * The geometry this container was last laid out with.
+	 */
+	struct {
+		double x, y, width, height;
+	} arranged;
+	/**
+	 * The nearest output and workspace ancestors of this container, or NULL
+	 * if there is none. Updated by layout.c whenever the container is
+	 * reparented; use swayc_parent_by_type to read them.
+	 */
+	struct sway_container *output;
+	struct sway_container *workspace;
+
+	/**
+	 * For workspaces, a grid over their floating views for hit testing,
+	 * mapping cells to lists of the views overlapping them, bottom to top.
+	 */
+	hash_t *floating_index;
+	/**
+	 * For floating views, the workspace whose floating index lists this view
+	 * and the range of cells it is listed in.
+	 */
+	struct sway_container *indexed_in;
+	int cell_x1, cell_y1, cell_x2, cell_y2;
+
+	/**
+	 * Links freed containers kept for reuse by new_swayc.
+	 */
+	struct sway_container *next_free;
+};
+
+/**
+ * Allocation statistics for one type of container.
+ */
+struct swayc_pool_stats {
+	int live;					/**< Containers currently in use. */
+	int cached;					/**< Freed containers kept for reuse. */
+	unsigned long allocated;	/**< Containers allocated from the heap. */
+	unsigned long reused;		/**< Containers handed out from the pool. */
 };
 
 enum visibility_mask {
 	VISIBLE = true
-} visible;
+};
 
 /**
  * Allocates a new output container.
@@ -129,6 +188,16 @@ swayc_t *new_view(swayc_t *sibling, wlc_handle handle);
  */
 swayc_t *new_floating_view(wlc_handle handle);
 
+/**
+ * Sets how many freed containers of each type are kept for reuse, releasing
+ * any over the new size. With 0 every container comes from the heap.
+ */
+void swayc_pool_set_size(int size);
+/**
+ * Returns allocation statistics for containers of the given type.
+ */
+const struct swayc_pool_stats *swayc_pool_stats(enum swayc_types type);
+
 /**
  * Frees an output's container.
  */
@@ -194,6 +263,15 @@ swayc_t *swayc_active_workspace_for(swayc_t *view);
  * Finds the container currently underneath the pointer.
  */
 swayc_t *container_under_pointer(void);
+/**
+ * Updates the cells a floating view is listed in within its workspace's
+ * floating index after it was added, moved, resized or raised.
+ */
+void floating_index_update(swayc_t *view);
+/**
+ * Removes a view from the floating index it is listed in, if any.
+ */
+void floating_index_remove(swayc_t *view);
 
 /**
  * Returns true if a container is fullscreen.
@@ -224,6 +302,25 @@ int swayc_gap(swayc_t *container);
  */
 void container_map(swayc_t *, void (*f)(swayc_t *, void *), void *);
 
+/**
+ * Walks a subtree in pre-order, tiled children before floating ones, without
+ * recursion or allocations. Containers of type max_type are visited but not
+ * descended into, so e.g. C_WORKSPACE visits outputs and workspaces only.
+ * Stopping early is just not calling swayc_iter_next again.
+ */
+struct swayc_iter {
+	swayc_t *top;
+	swayc_t *current;
+	enum swayc_types max_type;
+};
+
+void swayc_iter_init(struct swayc_iter *iter, swayc_t *top, enum swayc_types max_type);
+/**
+ * Returns the next container, starting with top itself, or NULL when the
+ * subtree is done. The tree must not be changed while it is walked.
+ */
+swayc_t *swayc_iter_next(struct swayc_iter *iter);
+
 /**
  * Set a view as visible or invisible.
  *
@@ -0,0 +1,25 @@
+#ifndef _SWAY_FLIGHT_H
+#define _SWAY_FLIGHT_H
+
+enum flight_event_type {
+	FLIGHT_WLC,
+	FLIGHT_COMMAND,
+	FLIGHT_ARRANGE,
+	FLIGHT_FOCUS,
+};
+
+/**
+ * Records an event in the flight recorder, a fixed size in-memory ring of the
+ * most recent events that is dumped when sway crashes. object is the
+ * container or handle involved, detail is copied and truncated. Cheap enough
+ * to be left on at all times.
+ */
+void flight_record(enum flight_event_type type, const void *object, const char *detail);
+
+/**
+ * Writes the recorded events to fd, oldest first. Doesn't allocate, so it can
+ * be used from a signal handler.
+ */
+void flight_dump(int fd);
+
+#endif
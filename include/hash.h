@@ -0,0 +1,26 @@
+#ifndef _SWAY_HASH_H
+#define _SWAY_HASH_H
+#include <stdint.h>
+
+struct hash_entry {
+	uint64_t key;
+	void *value;
+};
+
+// Open addressing hash table mapping integer keys to non-NULL pointers.
+typedef struct {
+	int capacity;
+	int length;
+	struct hash_entry *entries;
+} hash_t;
+
+hash_t *create_hash(void);
+void hash_free(hash_t *hash);
+// Stores value for key, replacing any previous value. value must not be NULL.
+void hash_set(hash_t *hash, uint64_t key, void *value);
+// Returns the value stored for key, or NULL if there is none.
+void *hash_get(hash_t *hash, uint64_t key);
+// Removes key and returns the value that was stored for it, or NULL.
+void *hash_del(hash_t *hash, uint64_t key);
+
+#endif
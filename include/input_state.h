@@ -15,6 +15,10 @@ void press_key(uint32_t key_sym, uint32_t key_code);
 // unsets a key as pressed
 void release_key(uint32_t key_sym, uint32_t key_code);
 
+// returns the keysyms of the pressed keys and sets count to their number,
+// valid until the next key is pressed or released
+const uint32_t *pressed_keysyms(int *count);
+
 
 /* Pointer state */
 
@@ -12,7 +12,8 @@ enum ipc_command_type {
 	IPC_GET_MARKS = 5,
 	IPC_GET_BAR_CONFIG = 6,
 	IPC_GET_VERSION	= 7,
-	IPC_SWAY_GET_PIXELS = 0x81
+	IPC_SWAY_GET_PIXELS = 0x81,
+	IPC_SWAY_GET_STATS = 0x82
 };
 
 void ipc_init(void);
@@ -13,6 +13,26 @@ extern list_t *scratchpad;
 extern int min_sane_w;
 extern int min_sane_h;
 
+/**
+ * Counts of arrange requests and the layout passes they were coalesced into,
+ * of view geometry changes sent to clients or skipped as unchanged, and of
+ * layout transactions. The transaction times only cover computing and sending
+ * the layout; wlc doesn't tell us when clients have applied it, so client
+ * latency is not included.
+ */
+struct layout_stats {
+	unsigned long arrange_requested;
+	unsigned long arrange_executed;
+	unsigned long geometry_sent;
+	unsigned long geometry_skipped;
+	unsigned long transactions;
+	unsigned long transaction_views;
+	unsigned long transaction_compute_usec;
+	unsigned long transaction_compute_max_usec;
+};
+
+extern struct layout_stats layout_stats;
+
 // Set initial values for root_container
 void init_layout(void);
 
@@ -39,9 +59,16 @@ swayc_t *replace_child(swayc_t *child, swayc_t *new_child);
 // a sibling, or to a floating window, or NULL
 swayc_t *remove_child(swayc_t *child);
 
+// Moves all children of source to the end of parent's children in one go. If
+// parent has no focus, it is set to the first moved child.
+void move_children(swayc_t *source, swayc_t *parent);
+
 // 2 containers are swapped, they inherit eachothers focus
 void swap_container(swayc_t *a, swayc_t *b);
 
+// Moves a floating view to the end (top) of its workspace's floating list
+void raise_floating(swayc_t *child);
+
 // 2 Containers geometry are swapped, used with `swap_container`
 void swap_geometry(swayc_t *a, swayc_t *b);
 
@@ -51,7 +78,25 @@ void move_workspace_to(swayc_t* workspace, swayc_t* destination);
 
 // Layout
 void update_geometry(swayc_t *view);
+// Schedules container to be laid out on the next arrange_windows_flush. Requests
+// are merged into their common ancestor, which is laid out once, descending
+// only into dirty or moved containers. Clean subtrees whose geometry did not
+// change keep their previous layout.
 void arrange_windows(swayc_t *container, double width, double height);
+// Runs the pending layout pass, if any. Called once the current event has been
+// handled and before anything reads container geometry.
+void arrange_windows_flush(void);
+// While a layout transaction is open, geometry computed for views is collected
+// instead of being sent right away. Committing the outermost transaction sends
+// all of it to the clients back to back, without waiting for them to
+// acknowledge it. Transactions may be nested.
+void layout_transaction_begin(void);
+void layout_transaction_commit(void);
+// Marks container and its ancestors as needing to be arranged
+void invalidate_layout(swayc_t *container);
+// Marks container, its ancestors and all of its descendants as needing to be
+// arranged, for changes such as gaps that affect every view below it
+void invalidate_layout_r(swayc_t *container);
 
 swayc_t *get_focused_container(swayc_t *parent);
 swayc_t *get_swayc_in_direction(swayc_t *container, enum movement_direction dir);
@@ -8,10 +8,18 @@ typedef struct {
 } list_t;
 
 list_t *create_list(void);
+// Creates a list that stores up to capacity items in the same allocation as
+// the list itself, for lists that usually stay small.
+list_t *create_list_inline(int capacity);
 void list_free(list_t *list);
 void list_add(list_t *list, void *item);
 void list_insert(list_t *list, int index, void *item);
 void list_del(list_t *list, int index);
+// Removes count items starting at index
+void list_remove_range(list_t *list, int index, int count);
+// Inserts count items of source starting at start into list at index.
+// source must not be list.
+void list_splice(list_t *list, int index, list_t *source, int start, int count);
 void list_cat(list_t *list, list_t *source);
 // See qsort
 void list_sort(list_t *list, int compare(const void *left, const void *right));
@@ -10,7 +10,30 @@ typedef enum {
 	L_DEBUG = 3,
 } log_importance_t;
 
+/**
+ * The current log level, messages less important than it are not logged.
+ */
+extern log_importance_t loglevel;
+
+/**
+ * Messages less important than this are compiled out. Defaults to leaving out
+ * debug messages from release builds.
+ */
+#ifndef SWAY_MAX_LOG_LEVEL
+#ifdef NDEBUG
+#define SWAY_MAX_LOG_LEVEL L_INFO
+#else
+#define SWAY_MAX_LOG_LEVEL L_DEBUG
+#endif
+#endif
+
 void init_log(log_importance_t verbosity);
+/**
+ * Appends log messages to the file at path instead of stderr. Must be called
+ * before init_log. If the file can't be opened, logging stays on stderr and
+ * false is returned.
+ */
+bool set_log_file(const char *path);
 void set_log_level(log_importance_t verbosity);
 void reset_log_level(void);
 // returns whether debug logging is on after switching.
@@ -23,14 +46,23 @@ bool _sway_assert(bool condition, const char* format, ...) __attribute__((format
 #define sway_assert(COND, FMT, ...) \
 	_sway_assert(COND, "%s:" FMT, __PRETTY_FUNCTION__, ##__VA_ARGS__)
 
+// The level is checked before the arguments are evaluated
 #ifndef NDEBUG
 void _sway_log(const char *filename, int line, log_importance_t verbosity, const char* format, ...) __attribute__((format(printf,4,5)));
 #define sway_log(VERBOSITY, FMT, ...) \
-	_sway_log(__FILE__, __LINE__, VERBOSITY, FMT, ##__VA_ARGS__)
+	do { \
+		if ((VERBOSITY) <= SWAY_MAX_LOG_LEVEL && (VERBOSITY) <= loglevel) { \
+			_sway_log(__FILE__, __LINE__, VERBOSITY, FMT, ##__VA_ARGS__); \
+		} \
+	} while (0)
 #else
 void _sway_log(log_importance_t verbosity, const char* format, ...) __attribute__((format(printf,2,3)));
 #define sway_log(VERBOSITY, FMT, ...) \
-	_sway_log(VERBOSITY, FMT, ##__VA_ARGS__)
+	do { \
+		if ((VERBOSITY) <= SWAY_MAX_LOG_LEVEL && (VERBOSITY) <= loglevel) { \
+			_sway_log(VERBOSITY, FMT, ##__VA_ARGS__); \
+		} \
+	} while (0)
 #endif
 
 void error_handler(int sig);
@@ -0,0 +1,43 @@
+#ifndef _SWAY_STATS_H
+#define _SWAY_STATS_H
+#include <stdint.h>
+#include <json-c/json.h>
+
+/**
+ * Entry points whose latency is measured.
+ */
+enum stats_probe {
+	STATS_OUTPUT_CREATED,
+	STATS_OUTPUT_DESTROYED,
+	STATS_OUTPUT_RESOLUTION,
+	STATS_OUTPUT_FOCUS,
+	STATS_OUTPUT_PRE_RENDER,
+	STATS_VIEW_CREATED,
+	STATS_VIEW_DESTROYED,
+	STATS_VIEW_GEOMETRY_REQUEST,
+	STATS_VIEW_STATE_REQUEST,
+	STATS_KEY,
+	STATS_POINTER_MOTION,
+	STATS_POINTER_BUTTON,
+	STATS_COMMAND,
+	STATS_ARRANGE,
+	STATS_PROBE_COUNT,
+};
+
+/**
+ * Returns the current monotonic time in nanoseconds, to be passed to
+ * stats_record when the measured code is done.
+ */
+uint64_t stats_begin(void);
+
+/**
+ * Adds the time since start to the histogram of probe.
+ */
+void stats_record(enum stats_probe probe, uint64_t start);
+
+/**
+ * Describes the histograms and layout counters, for IPC_SWAY_GET_STATS.
+ */
+json_object *stats_json(void);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef _SWAY_TRACE_H
+#define _SWAY_TRACE_H
+#include <stdbool.h>
+#include <stdint.h>
+#include "clock.h"
+
+/**
+ * Whether spans are being recorded, toggled with the trace command.
+ */
+extern bool trace_enabled;
+
+/**
+ * Records a span from start to end (from clock_now_ns). name and category must
+ * be string literals or otherwise outlive the trace.
+ */
+void trace_span(const char *name, const char *category, uint64_t start, uint64_t end);
+
+/**
+ * Starting a span costs a single branch while tracing is off. Spans whose
+ * start was taken before tracing was turned on are dropped.
+ */
+#define trace_begin() (trace_enabled ? clock_now_ns() : 0)
+#define trace_end(NAME, CATEGORY, START) \
+	do { \
+		if (trace_enabled && (START)) { \
+			trace_span(NAME, CATEGORY, START, clock_now_ns()); \
+		} \
+	} while (0)
+
+// Discards any previous trace and starts recording.
+void trace_start(void);
+void trace_stop(void);
+
+/**
+ * Writes the recorded spans to path in the Chrome trace event format, which
+ * can be loaded in chrome://tracing or Perfetto.
+ */
+bool trace_save(const char *path);
+
+#endif
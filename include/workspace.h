@@ -10,6 +10,13 @@ extern char *prev_workspace_name;
 char *workspace_next_name(void);
 swayc_t *workspace_create(const char*);
 swayc_t *workspace_by_name(const char*);
+// The key of a workspace name in the name index, the same for names that only
+// differ in case.
+uint64_t workspace_name_key(const char *name);
+// Keep the workspace name index up to date, called by
+// new_workspace and when a workspace is freed.
+void workspace_index_add(swayc_t *workspace);
+void workspace_index_remove(swayc_t *workspace);
 bool workspace_switch(swayc_t*);
 swayc_t *workspace_output_next();
 swayc_t *workspace_next();
@@ -23,6 +23,9 @@
 #include "sway.h"
 #include "resize.h"
 #include "input_state.h"
+#include "flight.h"
+#include "stats.h"
+#include "trace.h"
 
 typedef struct cmd_results *sway_cmd(int argc, char **argv);
 
@@ -144,6 +147,7 @@ static struct cmd_results *cmd_bindsym(int argc, char **argv) {
 	binding->keys = create_list();
 	binding->modifiers = 0;
 	binding->command = join_args(argv + 1, argc - 1);
+	binding->compiled = compile_command(binding->command);
 
 	list_t *split = split_string(argv[0], "+");
 	for (int i = 0; i < split->length; ++i) {
@@ -182,6 +186,7 @@ static struct cmd_results *cmd_bindsym(int argc, char **argv) {
 	}
 	list_add(mode->bindings, binding);
 	list_sort(mode->bindings, sway_binding_cmp);
+	free_mode_bindings_index(mode);
 
 	sway_log(L_DEBUG, "bindsym - Bound %s to command %s", argv[0], binding->command);
 	return cmd_results_new(CMD_SUCCESS, NULL, NULL);
@@ -262,8 +267,10 @@ static struct cmd_results *cmd_debuglog(int argc, char **argv) {
 		sway_log(L_DEBUG, "Debuglog turned on.");
 	} else if (strcasecmp(argv[0], "off") == 0) {
 		reset_log_level();
+	} else if (strcasecmp(argv[0], "events") == 0) {
+		flight_dump(STDERR_FILENO);
 	} else {
-		return cmd_results_new(CMD_FAILURE, "debuglog", "Expected 'debuglog on|off|toggle'");
+		return cmd_results_new(CMD_FAILURE, "debuglog", "Expected 'debuglog on|off|toggle|events'");
 	}
 	return cmd_results_new(CMD_SUCCESS, NULL, NULL);
 }
@@ -496,7 +503,10 @@ static void hide_view_in_scratchpad(swayc_t *sp_view) {
 	swayc_t *ws = sp_view->parent;
 	remove_child(sp_view);
 	if (swayc_active_workspace() != ws && ws->floating->length == 0 && ws->children->length == 0) {
-		destroy_workspace(ws);
+		swayc_t *output = destroy_workspace(ws);
+		if (output) {
+			ws = output;
+		}
 	}
 	arrange_windows(ws, -1, -1);
 	set_focused_container(container_under_pointer());
@@ -533,6 +543,9 @@ static struct cmd_results *cmd_mode(int argc, char **argv) {
 		mode = malloc(sizeof*mode);
 		mode->name = strdup(mode_name);
 		mode->bindings = create_list();
+		mode->key_bindings = NULL;
+		mode->chord_bindings = NULL;
+		mode->workspace_names = NULL;
 		list_add(config->modes, mode);
 	}
 	if (!mode) {
@@ -829,6 +842,7 @@ static struct cmd_results *cmd_gaps(int argc, char **argv) {
 			return cmd_results_new(CMD_INVALID, "gaps", "Number is out out of range.");
 		}
 		config->gaps_inner = config->gaps_outer = amount;
+		invalidate_layout_r(&root_container);
 		arrange_windows(&root_container, -1, -1);
 		return cmd_results_new(CMD_SUCCESS, NULL, NULL);
 	}
@@ -845,6 +859,7 @@ static struct cmd_results *cmd_gaps(int argc, char **argv) {
 		} else if (strcasecmp(target_str, "outer") == 0) {
 			config->gaps_outer = amount;
 		}
+		invalidate_layout_r(&root_container);
 		arrange_windows(&root_container, -1, -1);
 		return cmd_results_new(CMD_SUCCESS, NULL, NULL);
 	} else if (argc == 2 && strcasecmp(argv[0], "edge_gaps") == 0) {
@@ -859,6 +874,7 @@ static struct cmd_results *cmd_gaps(int argc, char **argv) {
 			config->edge_gaps =
 				(strcasecmp(argv[1], "yes") == 0 || strcasecmp(argv[1], "on") == 0);
 		}
+		invalidate_layout_r(&root_container);
 		arrange_windows(&root_container, -1, -1);
 		return cmd_results_new(CMD_SUCCESS, NULL, NULL);
 	}
@@ -934,6 +950,7 @@ static struct cmd_results *cmd_gaps(int argc, char **argv) {
 		} else if ((cont->gaps += amount) < 0) {
 			cont->gaps = 0;
 		}
+		invalidate_layout(cont);
 		arrange_windows(cont->parent, -1, -1);
 	} else if (inout == OUTER) {
 		//resize all workspace.
@@ -947,6 +964,7 @@ static struct cmd_results *cmd_gaps(int argc, char **argv) {
 				} else if ((ws->gaps += amount) < 0) {
 					ws->gaps = 0;
 				}
+				invalidate_layout(ws);
 			}
 		}
 		arrange_windows(&root_container, -1, -1);
@@ -963,6 +981,7 @@ static struct cmd_results *cmd_gaps(int argc, char **argv) {
 		int top_gap = top->gaps;
 		container_map(top, method == SET ? set_gaps : add_gaps, &amount);
 		top->gaps = top_gap;
+		invalidate_layout_r(top);
 		arrange_windows(top, -1, -1);
 	}
 
@@ -1251,6 +1270,7 @@ static struct cmd_results *cmd_fullscreen(int argc, char **argv) {
 	swayc_t *container = get_focused_view(&root_container);
 	bool current = swayc_is_fullscreen(container);
 	wlc_view_set_state(container->handle, WLC_BIT_FULLSCREEN, !current);
+	invalidate_layout(container);
 	// Resize workspace if going from  fullscreen -> notfullscreen
 	// otherwise just resize container
 	if (current) {
@@ -1326,6 +1346,34 @@ static struct cmd_results *cmd_workspace(int argc, char **argv) {
 	return cmd_results_new(CMD_SUCCESS, NULL, NULL);
 }
 
+static struct cmd_results *cmd_trace(int argc, char **argv) {
+	struct cmd_results *error = NULL;
+	if ((error = checkarg(argc, "trace", EXPECTED_AT_LEAST, 1))) {
+		return error;
+	}
+	if (config->reading) {
+		return cmd_results_new(CMD_FAILURE, "trace", "Can't be used in config file.");
+	}
+	if (strcasecmp(argv[0], "start") == 0) {
+		trace_start();
+	} else if (strcasecmp(argv[0], "stop") == 0) {
+		trace_stop();
+	} else if (strcasecmp(argv[0], "save") == 0) {
+		if ((error = checkarg(argc, "trace save", EXPECTED_MORE_THAN, 1))) {
+			return error;
+		}
+		char *path = join_args(argv + 1, argc - 1);
+		bool saved = trace_save(path);
+		free(path);
+		if (!saved) {
+			return cmd_results_new(CMD_FAILURE, "trace save", "Unable to write trace");
+		}
+	} else {
+		return cmd_results_new(CMD_INVALID, "trace", "Expected 'trace start|stop|save <file>'");
+	}
+	return cmd_results_new(CMD_SUCCESS, NULL, NULL);
+}
+
 static struct cmd_results *cmd_ws_auto_back_and_forth(int argc, char **argv) {
 	struct cmd_results *error = NULL;
 	if ((error = checkarg(argc, "workspace_auto_back_and_forth", EXPECTED_EQUAL_TO, 1))) {
@@ -1370,6 +1418,7 @@ static struct cmd_handler handlers[] = {
 	{ "split", cmd_split },
 	{ "splith", cmd_splith },
 	{ "splitv", cmd_splitv },
+	{ "trace", cmd_trace },
 	{ "workspace", cmd_workspace },
 	{ "workspace_auto_back_and_forth", cmd_ws_auto_back_and_forth },
 };
@@ -1392,6 +1441,7 @@ struct cmd_results *handle_command(char *_exec) {
 	// Even though this function will process multiple commands we will only
 	// return the last error, if any (for now). (Since we have access to an
 	// error string we could e.g. concatonate all errors there.)
+	uint64_t start = stats_begin();
 	struct cmd_results *results = NULL;
 	char *exec = strdup(_exec);
 	char *head = exec;
@@ -1442,6 +1492,7 @@ struct cmd_results *handle_command(char *_exec) {
 				continue;
 			}
 			sway_log(L_INFO, "Handling command '%s'", cmd);
+			flight_record(FLIGHT_COMMAND, NULL, cmd);
 			//TODO better handling of argv
 			int argc;
 			char **argv = split_args(cmd, &argc);
@@ -1458,6 +1509,8 @@ struct cmd_results *handle_command(char *_exec) {
 				goto cleanup;
 			}
 			struct cmd_results *res = handler->handle(argc-1, argv+1);
+			// Later commands in the chain may look at the layout
+			arrange_windows_flush();
 			if (res->status != CMD_SUCCESS) {
 				free_argv(argc, argv);
 				if (results) {
@@ -1475,6 +1528,102 @@ struct cmd_results *handle_command(char *_exec) {
 	if (!results) {
 		results = cmd_results_new(CMD_SUCCESS, NULL, NULL);
 	}
+	stats_record(STATS_COMMAND, start);
+	return results;
+}
+
+struct compiled_cmd {
+	struct cmd_handler *handler;
+	int argc;
+	char **argv;
+};
+
+struct cmd_list {
+	int length;
+	struct compiled_cmd *cmds;
+	// Held while executing, so a reload run by the list does not free it
+	int refs;
+};
+
+struct cmd_list *compile_command(const char *command) {
+	struct cmd_list *list = calloc(1, sizeof(struct cmd_list));
+	list->refs = 1;
+	char *exec = strdup(command);
+	char *head = exec;
+	do {
+		// Criteria are refused when the command is run
+		if (*head == '[') {
+			goto fail;
+		}
+		char *cmdlist = argsep(&head, ";");
+		cmdlist += strspn(cmdlist, whitespace);
+		do {
+			char *cmd = argsep(&cmdlist, ",");
+			cmd += strspn(cmd, whitespace);
+			if (strcmp(cmd, "") == 0) {
+				continue;
+			}
+			int argc;
+			char **argv = split_args(cmd, &argc);
+			if (argc>1 && (*argv[1] == '\"' || *argv[1] == '\'')) {
+				strip_quotes(argv[1]);
+			}
+			struct cmd_handler *handler = find_handler(argv[0]);
+			if (!handler) {
+				// Reported when the command is run
+				free_argv(argc, argv);
+				goto fail;
+			}
+			list->cmds = realloc(list->cmds, (list->length + 1) * sizeof(struct compiled_cmd));
+			struct compiled_cmd *compiled = &list->cmds[list->length++];
+			compiled->handler = handler;
+			compiled->argc = argc;
+			compiled->argv = argv;
+		} while(cmdlist);
+	} while(head);
+	free(exec);
+	return list;
+fail:
+	free(exec);
+	free_cmd_list(list);
+	return NULL;
+}
+
+void free_cmd_list(struct cmd_list *list) {
+	if (!list || --list->refs > 0) {
+		return;
+	}
+	int i;
+	for (i = 0; i < list->length; ++i) {
+		free_argv(list->cmds[i].argc, list->cmds[i].argv);
+	}
+	free(list->cmds);
+	free(list);
+}
+
+struct cmd_results *handle_compiled_command(struct cmd_list *list) {
+	uint64_t start = stats_begin();
+	struct cmd_results *results = NULL;
+	++list->refs;
+	int i;
+	for (i = 0; i < list->length; ++i) {
+		struct compiled_cmd *cmd = &list->cmds[i];
+		sway_log(L_INFO, "Handling command '%s'", cmd->argv[0]);
+		flight_record(FLIGHT_COMMAND, list, cmd->argv[0]);
+		struct cmd_results *res = cmd->handler->handle(cmd->argc - 1, cmd->argv + 1);
+		// Later commands in the chain may look at the layout
+		arrange_windows_flush();
+		if (res->status != CMD_SUCCESS) {
+			results = res;
+			break;
+		}
+		free_cmd_results(res);
+	}
+	free_cmd_list(list);
+	if (!results) {
+		results = cmd_results_new(CMD_SUCCESS, NULL, NULL);
+	}
+	stats_record(STATS_COMMAND, start);
 	return results;
 }
 
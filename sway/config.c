@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <strings.h>
 #include <unistd.h>
 #include "readline.h"
 #include "stringop.h"
@@ -10,6 +11,7 @@
 #include "config.h"
 #include "layout.h"
 #include "input_state.h"
+#include "workspace.h"
 
 struct sway_config *config = NULL;
 
@@ -23,11 +25,13 @@ static void free_variable(struct sway_variable *var) {
 static void free_binding(struct sway_binding *bind) {
 	free_flat_list(bind->keys);
 	free(bind->command);
+	free_cmd_list(bind->compiled);
 	free(bind);
 }
 
 static void free_mode(struct sway_mode *mode) {
 	free(mode->name);
+	free_mode_bindings_index(mode);
 	int i;
 	for (i = 0; i < mode->bindings->length; ++i) {
 		free_binding(mode->bindings->items[i]);
@@ -90,6 +94,9 @@ static void config_defaults(struct sway_config *config) {
 	config->current_mode->name = malloc(sizeof("default"));
 	strcpy(config->current_mode->name, "default");
 	config->current_mode->bindings = create_list();
+	config->current_mode->key_bindings = NULL;
+	config->current_mode->chord_bindings = NULL;
+	config->current_mode->workspace_names = NULL;
 	list_add(config->modes, config->current_mode);
 
 	config->floating_mod = 0;
@@ -275,8 +282,14 @@ bool read_config(FILE *file, bool is_active) {
 		free(res);
 	}
 
+	int i;
+	for (i = 0; i < config->modes->length; ++i) {
+		compile_mode_bindings(config->modes->items[i]);
+	}
+
 	if (is_active) {
 		config->reloading = false;
+		invalidate_layout_r(&root_container);
 		arrange_windows(&root_container, -1, -1);
 	}
 	if (old_config) {
@@ -422,6 +435,121 @@ int sway_binding_cmp(const void *a, const void *b) {
 	return lenient_strcmp(binda->command, bindb->command);
 }
 
+static uint64_t binding_key(uint32_t modifiers, xkb_keysym_t sym) {
+	return (uint64_t)modifiers << 32 | sym;
+}
+
+void free_mode_bindings_index(struct sway_mode *mode) {
+	if (mode->key_bindings) {
+		hash_free(mode->key_bindings);
+		mode->key_bindings = NULL;
+	}
+	if (mode->chord_bindings) {
+		list_free(mode->chord_bindings);
+		mode->chord_bindings = NULL;
+	}
+	if (mode->workspace_names) {
+		free_flat_list(mode->workspace_names);
+		mode->workspace_names = NULL;
+	}
+}
+
+// Adds the workspace a `workspace <name>` binding switches to, if it is one.
+// seen maps the workspace name keys of names to the names, for finding
+// duplicates without comparing against every name.
+static void add_workspace_name(list_t *names, hash_t *seen, const char *command) {
+	list_t *args = split_string(command, " ");
+	if (args->length > 1 && strcmp("workspace", args->items[0]) == 0) {
+		const char *target = args->items[1];
+		// Make sure that the command references an actual workspace
+		// not a command about workspaces
+		if (strcmp(target, "next") != 0 &&
+				strcmp(target, "prev") != 0 &&
+				strcmp(target, "next_on_output") != 0 &&
+				strcmp(target, "prev_on_output") != 0 &&
+				strcmp(target, "number") != 0 &&
+				strcmp(target, "back_and_forth") != 0 &&
+				strcmp(target, "current") != 0) {
+			// Workspace names match case insensitively, so a name that only
+			// differs in case from an earlier one can never be free before it
+			uint64_t key = workspace_name_key(target);
+			const char *name = hash_get(seen, key);
+			if (!name) {
+				char *copy = strdup(target);
+				list_add(names, copy);
+				hash_set(seen, key, copy);
+			} else if (strcasecmp(name, target) != 0) {
+				// Names with the same key are rare, such a name is just
+				// listed without being checked for duplicates
+				list_add(names, strdup(target));
+			}
+		}
+	}
+	free_flat_list(args);
+}
+
+void compile_mode_bindings(struct sway_mode *mode) {
+	free_mode_bindings_index(mode);
+	mode->key_bindings = create_hash();
+	mode->chord_bindings = create_list();
+	mode->workspace_names = create_list();
+	hash_t *seen = create_hash();
+	int i;
+	for (i = 0; i < mode->bindings->length; ++i) {
+		struct sway_binding *binding = mode->bindings->items[i];
+		add_workspace_name(mode->workspace_names, seen, binding->command);
+		if (binding->keys->length > 1) {
+			list_add(mode->chord_bindings, binding);
+		} else if (binding->keys->length == 1) {
+			xkb_keysym_t *sym = binding->keys->items[0];
+			uint64_t key = binding_key(binding->modifiers, *sym);
+			// bindings is sorted, keep the first one like a scan would
+			if (!hash_get(mode->key_bindings, key)) {
+				hash_set(mode->key_bindings, key, binding);
+			}
+		}
+		// Bindings without keys can not be triggered
+	}
+	hash_free(seen);
+}
+
+struct sway_binding *get_pressed_binding(struct sway_mode *mode, uint32_t modifiers) {
+	if (!mode->key_bindings) {
+		compile_mode_bindings(mode);
+	}
+	int i, j;
+	// Chords are sorted with the longest first
+	for (i = 0; i < mode->chord_bindings->length; ++i) {
+		struct sway_binding *binding = mode->chord_bindings->items[i];
+		if (binding->modifiers != modifiers) {
+			continue;
+		}
+		for (j = 0; j < binding->keys->length; ++j) {
+			xkb_keysym_t *key = binding->keys->items[j];
+			if (!check_key(*key, 0)) {
+				break;
+			}
+		}
+		if (j == binding->keys->length) {
+			return binding;
+		}
+	}
+	// Of the single keys, the lowest keysym sorts first
+	struct sway_binding *match = NULL;
+	uint32_t match_sym = 0;
+	int count;
+	const uint32_t *syms = pressed_keysyms(&count);
+	for (i = 0; i < count; ++i) {
+		struct sway_binding *binding =
+			hash_get(mode->key_bindings, binding_key(modifiers, syms[i]));
+		if (binding && (!match || syms[i] < match_sym)) {
+			match = binding;
+			match_sym = syms[i];
+		}
+	}
+	return match;
+}
+
 void free_sway_binding(struct sway_binding *binding) {
 	if (binding->keys) {
 		for (int i = 0; i < binding->keys->length; i++) {
@@ -432,5 +560,6 @@ void free_sway_binding(struct sway_binding *binding) {
 	if (binding->command) {
 		free(binding->command);
 	}
+	free_cmd_list(binding->compiled);
 	free(binding);
 }
@@ -3,6 +3,7 @@
 #include <strings.h>
 #include <string.h>
 #include "config.h"
+#include "hash.h"
 #include "stringop.h"
 #include "container.h"
 #include "workspace.h"
@@ -14,14 +15,64 @@
 #define ASSERT_NONNULL(PTR) \
 	sway_assert (PTR, #PTR "must be non-null")
 
+// Maps wlc handles of outputs and views to their containers
+static hash_t *handle_index = NULL;
+
+static void index_handle(swayc_t *cont) {
+	if (!handle_index) {
+		handle_index = create_hash();
+	}
+	hash_set(handle_index, cont->handle, cont);
+}
+
+// Freed containers are kept on a free list per container type, along with
+// their (emptied) child lists, and handed out again by new_swayc.
+#define SWAYC_POOL_SIZE 128
+// Child lists that grew larger than this are released instead of kept
+#define SWAYC_POOL_LIST_CAPACITY 32
+// Most containers have only a few children, which are kept inline
+#define SWAYC_INLINE_CHILDREN 4
+
+static struct {
+	swayc_t *head;
+	struct swayc_pool_stats stats;
+} pools[C_TYPES];
+
+static int pool_size = SWAYC_POOL_SIZE;
+
+static list_t *recycle_list(list_t *list) {
+	if (list && list->capacity > SWAYC_POOL_LIST_CAPACITY) {
+		list_free(list);
+		return NULL;
+	}
+	return list;
+}
+
 static swayc_t *new_swayc(enum swayc_types type) {
-	swayc_t *c = calloc(1, sizeof(swayc_t));
+	swayc_t *c = pools[type].head;
+	list_t *children = NULL, *floating = NULL;
+	if (c) {
+		pools[type].head = c->next_free;
+		pools[type].stats.cached--;
+		pools[type].stats.reused++;
+		children = c->children;
+		floating = c->floating;
+		memset(c, 0, sizeof(swayc_t));
+	} else {
+		c = calloc(1, sizeof(swayc_t));
+		pools[type].stats.allocated++;
+	}
+	pools[type].stats.live++;
 	c->handle = -1;
 	c->gaps = -1;
 	c->layout = L_NONE;
 	c->type = type;
+	c->dirty = true;
 	if (type != C_VIEW) {
-		c->children = create_list();
+		c->children = children ? children : create_list_inline(SWAYC_INLINE_CHILDREN);
+	}
+	if (type == C_WORKSPACE) {
+		c->floating = floating ? floating : create_list_inline(SWAYC_INLINE_CHILDREN);
 	}
 	return c;
 }
@@ -32,21 +83,30 @@ static void free_swayc(swayc_t *cont) {
 	}
 	if (cont->children) {
 		// remove children until there are no more, free_swayc calls
-		// remove_child, which removes child from this container
+		// remove_child, which removes child from this container. Taking them
+		// from the end means nothing has to be shifted down.
 		while (cont->children->length) {
-			free_swayc(cont->children->items[0]);
+			free_swayc(cont->children->items[cont->children->length - 1]);
 		}
-		list_free(cont->children);
 	}
 	if (cont->floating) {
 		while (cont->floating->length) {
-			free_swayc(cont->floating->items[0]);
+			free_swayc(cont->floating->items[cont->floating->length - 1]);
 		}
-		list_free(cont->floating);
 	}
 	if (cont->parent) {
 		remove_child(cont);
 	}
+	if (cont->floating_index) {
+		hash_free(cont->floating_index);
+	}
+	if ((cont->type == C_OUTPUT || cont->type == C_VIEW)
+			&& hash_get(handle_index, cont->handle) == cont) {
+		hash_del(handle_index, cont->handle);
+	}
+	if (cont->type == C_WORKSPACE) {
+		workspace_index_remove(cont);
+	}
 	if (cont->name) {
 		free(cont->name);
 	}
@@ -56,7 +116,45 @@ static void free_swayc(swayc_t *cont) {
 	if (cont->app_id) {
 		free(cont->app_id);
 	}
-	free(cont);
+	enum swayc_types type = cont->type;
+	pools[type].stats.live--;
+	if (pools[type].stats.cached < pool_size) {
+		cont->children = recycle_list(cont->children);
+		cont->floating = recycle_list(cont->floating);
+		// Poison the links, so a stale pointer to this container looks
+		// detached instead of leading into other pooled containers
+		cont->type = C_TYPES;
+		cont->parent = NULL;
+		cont->focused = NULL;
+		cont->output = NULL;
+		cont->workspace = NULL;
+		cont->next_free = pools[type].head;
+		pools[type].head = cont;
+		pools[type].stats.cached++;
+	} else {
+		list_free(cont->children);
+		list_free(cont->floating);
+		free(cont);
+	}
+}
+
+void swayc_pool_set_size(int size) {
+	pool_size = size;
+	int type;
+	for (type = 0; type < C_TYPES; ++type) {
+		while (pools[type].stats.cached > size) {
+			swayc_t *cont = pools[type].head;
+			pools[type].head = cont->next_free;
+			pools[type].stats.cached--;
+			list_free(cont->children);
+			list_free(cont->floating);
+			free(cont);
+		}
+	}
+}
+
+const struct swayc_pool_stats *swayc_pool_stats(enum swayc_types type) {
+	return &pools[type].stats;
 }
 
 // New containers
@@ -96,6 +194,7 @@ swayc_t *new_output(wlc_handle handle) {
 
 	swayc_t *output = new_swayc(C_OUTPUT);
 	output->handle = handle;
+	index_handle(output);
 	output->name = name ? strdup(name) : NULL;
 	output->width = size->w;
 	output->height = size->h;
@@ -157,7 +256,7 @@ swayc_t *new_workspace(swayc_t *output, const char *name) {
 	workspace->height = output->height;
 	workspace->name = strdup(name);
 	workspace->visible = false;
-	workspace->floating = create_list();
+	workspace_index_add(workspace);
 
 	add_child(output, workspace);
 	return workspace;
@@ -219,6 +318,7 @@ swayc_t *new_view(swayc_t *sibling, wlc_handle handle) {
 		handle, title, sibling, sibling ? sibling->type : 0);
 	// Setup values
 	view->handle = handle;
+	index_handle(view);
 	view->name = title ? strdup(title) : NULL;
 	const char *class = wlc_view_get_class(handle);
 	view->class = class ? strdup(class) : NULL;
@@ -255,6 +355,7 @@ swayc_t *new_floating_view(wlc_handle handle) {
 		handle, wlc_view_get_type(handle), title);
 	// Setup values
 	view->handle = handle;
+	index_handle(view);
 	view->name = title ? strdup(title) : NULL;
 	const char *class = wlc_view_get_class(handle);
 	view->class = class ? strdup(class) : NULL;
@@ -277,10 +378,11 @@ swayc_t *new_floating_view(wlc_handle handle) {
 	view->is_floating = true;
 
 	// Case of focused workspace, just create as child of it
-	list_add(swayc_active_workspace()->floating, view);
-	view->parent = swayc_active_workspace();
-	if (swayc_active_workspace()->focused == NULL) {
-		set_focused_container_for(swayc_active_workspace(), view);
+	swayc_t *ws = swayc_active_workspace();
+	bool focus = ws->focused == NULL;
+	add_floating(ws, view);
+	if (focus) {
+		set_focused_container_for(ws, view);
 	}
 	return view;
 }
@@ -298,11 +400,7 @@ swayc_t *destroy_output(swayc_t *output) {
 		if (root_container.children->length > 1) {
 			int p = root_container.children->items[0] == output;
 			// Move workspace from this output to another output
-			while (output->children->length) {
-				swayc_t *child = output->children->items[0];
-				remove_child(child);
-				add_child(root_container.children->items[p], child);
-			}
+			move_children(output, root_container.children->items[p]);
 			update_visibility(root_container.children->items[p]);
 			arrange_windows(root_container.children->items[p], -1, -1);
 		}
@@ -368,27 +466,26 @@ swayc_t *destroy_view(swayc_t *view) {
 
 
 swayc_t *swayc_by_test(swayc_t *container, bool (*test)(swayc_t *view, void *data), void *data) {
-	if (!container->children) {
-		return NULL;
-	}
-	// Special case for checking floating stuff
-	int i;
-	if (container->type == C_WORKSPACE) {
-		for (i = 0; i < container->floating->length; ++i) {
-			swayc_t *child = container->floating->items[i];
-			if (test(child, data)) {
-				return child;
-			}
+	struct swayc_iter iter;
+	swayc_iter_init(&iter, container, C_VIEW);
+	swayc_t *child;
+	while ((child = swayc_iter_next(&iter))) {
+		// Floating views were already tested with their workspace
+		if (child->is_floating) {
+			continue;
 		}
-	}
-	for (i = 0; i < container->children->length; ++i) {
-		swayc_t *child = container->children->items[i];
-		if (test(child, data)) {
+		// container itself is not tested
+		if (child != container && test(child, data)) {
 			return child;
-		} else {
-			swayc_t *res = swayc_by_test(child, test, data);
-			if (res) {
-				return res;
+		}
+		// Floating views come before the tiled children of a workspace
+		if (child->type == C_WORKSPACE) {
+			int i;
+			for (i = 0; i < child->floating->length; ++i) {
+				swayc_t *view = child->floating->items[i];
+				if (test(view, data)) {
+					return view;
+				}
 			}
 		}
 	}
@@ -413,6 +510,12 @@ swayc_t *swayc_parent_by_type(swayc_t *container, enum swayc_types type) {
 	if (!sway_assert(type < C_TYPES && type >= C_ROOT, "invalid type")) {
 		return NULL;
 	}
+	// These are cached on every container when it is reparented
+	if (type == C_OUTPUT) {
+		return container->output;
+	} else if (type == C_WORKSPACE) {
+		return container->workspace;
+	}
 	do {
 		container = container->parent;
 	} while (container && container->type != type);
@@ -459,39 +562,16 @@ swayc_t *swayc_focus_by_layout(swayc_t *container, enum swayc_layouts layout) {
 }
 
 
-static swayc_t *_swayc_by_handle_helper(wlc_handle handle, swayc_t *parent) {
-	if (!parent || !parent->children) {
+swayc_t *swayc_by_handle(wlc_handle handle) {
+	if (!handle_index) {
 		return NULL;
 	}
-	int i, len;
-	swayc_t **child;
-	if (parent->type == C_WORKSPACE) {
-		len = parent->floating->length;
-		child = (swayc_t **)parent->floating->items;
-		for (i = 0; i < len; ++i, ++child) {
-			if ((*child)->handle == handle) {
-				return *child;
-			}
-		}
-	}
-
-	len = parent->children->length;
-	child = (swayc_t**)parent->children->items;
-	for (i = 0; i < len; ++i, ++child) {
-		if ((*child)->handle == handle) {
-			return *child;
-		} else {
-			swayc_t *res;
-			if ((res = _swayc_by_handle_helper(handle, *child))) {
-				return res;
-			}
-		}
+	swayc_t *cont = hash_get(handle_index, handle);
+	// Views outside of the tree (i.e. in the scratchpad) are not looked up
+	if (cont && !cont->parent) {
+		return NULL;
 	}
-	return NULL;
-}
-
-swayc_t *swayc_by_handle(wlc_handle handle) {
-	return _swayc_by_handle_helper(handle, &root_container);
+	return cont;
 }
 
 swayc_t *swayc_active_output(void) {
@@ -523,6 +603,86 @@ swayc_t *swayc_active_workspace_for(swayc_t *cont) {
 	}
 }
 
+// Floating views are indexed in square cells of this many pixels
+#define FLOATING_CELL_SIZE 256
+// Cells beyond this on either axis are not indexed
+#define FLOATING_MAX_CELL 63
+
+static uint64_t cell_key(int x, int y) {
+	return (uint64_t)x << 32 | (uint32_t)y;
+}
+
+static int cell_at(double coord) {
+	int cell = coord < 0 ? 0 : (int)(coord / FLOATING_CELL_SIZE);
+	return cell > FLOATING_MAX_CELL ? FLOATING_MAX_CELL : cell;
+}
+
+void floating_index_remove(swayc_t *view) {
+	swayc_t *ws = view->indexed_in;
+	if (!ws) {
+		return;
+	}
+	int x, y, i;
+	for (x = view->cell_x1; x <= view->cell_x2; ++x) {
+		for (y = view->cell_y1; y <= view->cell_y2; ++y) {
+			list_t *cell = hash_get(ws->floating_index, cell_key(x, y));
+			if (!cell) {
+				continue;
+			}
+			for (i = 0; i < cell->length; ++i) {
+				if (cell->items[i] == view) {
+					list_del(cell, i);
+					break;
+				}
+			}
+			if (cell->length == 0) {
+				hash_del(ws->floating_index, cell_key(x, y));
+				list_free(cell);
+			}
+		}
+	}
+	view->indexed_in = NULL;
+}
+
+void floating_index_update(swayc_t *view) {
+	swayc_t *ws = view->parent;
+	if (!view->is_floating || !ws || ws->type != C_WORKSPACE) {
+		floating_index_remove(view);
+		return;
+	}
+	int x1 = cell_at(view->x), x2 = cell_at(view->x + view->width - 1);
+	int y1 = cell_at(view->y), y2 = cell_at(view->y + view->height - 1);
+	if (view->indexed_in == ws && x1 == view->cell_x1 && x2 == view->cell_x2
+			&& y1 == view->cell_y1 && y2 == view->cell_y2) {
+		return;
+	}
+	floating_index_remove(view);
+	if (!ws->floating_index) {
+		ws->floating_index = create_hash();
+	}
+	int x, y;
+	for (x = x1; x <= x2; ++x) {
+		for (y = y1; y <= y2; ++y) {
+			list_t *cell = hash_get(ws->floating_index, cell_key(x, y));
+			if (!cell) {
+				cell = create_list();
+				hash_set(ws->floating_index, cell_key(x, y), cell);
+			}
+			// Cells are kept in stacking order, views are mostly added on top
+			int i = cell->length;
+			while (i > 0 && ((swayc_t *)cell->items[i - 1])->index > view->index) {
+				--i;
+			}
+			list_insert(cell, i, view);
+		}
+	}
+	view->indexed_in = ws;
+	view->cell_x1 = x1;
+	view->cell_x2 = x2;
+	view->cell_y1 = y1;
+	view->cell_y2 = y2;
+}
+
 static bool pointer_test(swayc_t *view, void *_origin) {
 	const struct wlc_point *origin = _origin;
 	// Determine the output that the view is under
@@ -535,7 +695,61 @@ static bool pointer_test(swayc_t *view, void *_origin) {
 	return false;
 }
 
+// Returns the topmost floating view of ws under origin
+static swayc_t *floating_under_point(swayc_t *ws, struct wlc_point *origin) {
+	if (!ws->floating_index || origin->x < 0 || origin->y < 0) {
+		return NULL;
+	}
+	list_t *cell = hash_get(ws->floating_index,
+			cell_key(cell_at(origin->x), cell_at(origin->y)));
+	if (!cell) {
+		return NULL;
+	}
+	// Every view in the cell is on ws, so only their rects need testing, from
+	// the top down
+	int i;
+	for (i = cell->length - 1; i >= 0; --i) {
+		swayc_t *view = cell->items[i];
+		if (view->visible && origin->x >= view->x && origin->y >= view->y
+				&& origin->x < view->x + view->width && origin->y < view->y + view->height) {
+			return swayc_parent_by_type(ws, C_OUTPUT) == root_container.focused ? view : NULL;
+		}
+	}
+	return NULL;
+}
+
+// Returns the child of container under origin. Children of horizontal and
+// vertical layouts are ordered by position, so they can be bisected.
+static swayc_t *child_under_point(swayc_t *container, struct wlc_point *origin) {
+	list_t *children = container->children;
+	if (container->layout != L_HORIZ && container->layout != L_VERT) {
+		int i;
+		for (i = 0; i < children->length; ++i) {
+			if (pointer_test(children->items[i], origin)) {
+				return children->items[i];
+			}
+		}
+		return NULL;
+	}
+	bool horiz = container->layout == L_HORIZ;
+	double pos = horiz ? origin->x : origin->y;
+	int lo = 0, hi = children->length - 1;
+	swayc_t *found = NULL;
+	while (lo <= hi) {
+		int mid = (lo + hi) / 2;
+		swayc_t *child = children->items[mid];
+		if ((horiz ? child->x : child->y) <= pos) {
+			found = child;
+			lo = mid + 1;
+		} else {
+			hi = mid - 1;
+		}
+	}
+	return found && pointer_test(found, origin) ? found : NULL;
+}
+
 swayc_t *container_under_pointer(void) {
+	arrange_windows_flush();
 	// root.output->workspace
 	if (!root_container.focused || !root_container.focused->focused) {
 		return NULL;
@@ -548,8 +762,6 @@ swayc_t *container_under_pointer(void) {
 	struct wlc_point origin;
 	wlc_pointer_get_position(&origin);
 	while (lookup->type != C_VIEW) {
-		int i;
-		int len;
 		// if tabbed/stacked go directly to focused container, otherwise search
 		// children
 		if (lookup->layout == L_TABBED || lookup->layout == L_STACKED) {
@@ -558,31 +770,19 @@ swayc_t *container_under_pointer(void) {
 		}
 		// if workspace, search floating
 		if (lookup->type == C_WORKSPACE) {
-			i = len = lookup->floating->length;
-			bool got_floating = false;
-			while (--i > -1) {
-				if (pointer_test(lookup->floating->items[i], &origin)) {
-					lookup = lookup->floating->items[i];
-					got_floating = true;
-					break;
-				}
-			}
-			if (got_floating) {
+			swayc_t *floating = floating_under_point(lookup, &origin);
+			if (floating) {
+				lookup = floating;
 				continue;
 			}
 		}
 		// search children
-		len = lookup->children->length;
-		for (i = 0; i < len; ++i) {
-			if (pointer_test(lookup->children->items[i], &origin)) {
-				lookup = lookup->children->items[i];
-				break;
-			}
-		}
+		swayc_t *child = child_under_point(lookup, &origin);
 		// when border and titles are done, this could happen
-		if (i == len) {
+		if (!child) {
 			break;
 		}
+		lookup = child;
 	}
 	return lookup;
 }
@@ -624,22 +824,52 @@ int swayc_gap(swayc_t *container) {
 // Mapping
 
 void container_map(swayc_t *container, void (*f)(swayc_t *view, void *data), void *data) {
-	if (container) {
-		f(container, data);
-		int i;
-		if (container->children)  {
-			for (i = 0; i < container->children->length; ++i) {
-				swayc_t *child = container->children->items[i];
-				container_map(child, f, data);
-			}
+	if (!container) {
+		return;
+	}
+	struct swayc_iter iter;
+	swayc_iter_init(&iter, container, C_VIEW);
+	swayc_t *child;
+	while ((child = swayc_iter_next(&iter))) {
+		f(child, data);
+	}
+}
+
+void swayc_iter_init(struct swayc_iter *iter, swayc_t *top, enum swayc_types max_type) {
+	iter->top = top;
+	iter->current = NULL;
+	iter->max_type = max_type;
+}
+
+swayc_t *swayc_iter_next(struct swayc_iter *iter) {
+	swayc_t *c = iter->current;
+	if (!c) {
+		// First call, or the walk is over and top was cleared
+		return iter->current = iter->top;
+	}
+	if (c->type < iter->max_type) {
+		if (c->children && c->children->length) {
+			return iter->current = c->children->items[0];
 		}
-		if (container->floating) {
-			for (i = 0; i < container->floating->length; ++i) {
-				swayc_t *child = container->floating->items[i];
-				container_map(child, f, data);
-			}
+		if (c->floating && c->floating->length) {
+			return iter->current = c->floating->items[0];
 		}
 	}
+	// Go to the next sibling, climbing up until there is one. Containers know
+	// their index, so no stack is needed.
+	while (c != iter->top) {
+		swayc_t *parent = c->parent;
+		list_t *siblings = c->is_floating ? parent->floating : parent->children;
+		if (c->index + 1 < siblings->length) {
+			return iter->current = siblings->items[c->index + 1];
+		}
+		if (!c->is_floating && parent->floating && parent->floating->length) {
+			return iter->current = parent->floating->items[0];
+		}
+		c = parent;
+	}
+	iter->top = iter->current = NULL;
+	return NULL;
 }
 
 void update_visibility_output(swayc_t *container, wlc_handle output) {
@@ -12,67 +12,86 @@
 #include <stringop.h>
 #include <execinfo.h>
 #include "workspace.h"
-
-extern log_importance_t v;
+#include "layout.h"
 
 /* XXX:DEBUG:XXX */
-static void container_log(const swayc_t *c) {
-	fprintf(stderr, "focus:%c|",
+static void container_log(const swayc_t *c, const char *indent) {
+	sway_log(L_DEBUG, "%sfocus:%c|(%p)(p:%p)(f:%p)(h:%ld)Type:%s|layout:%s|"
+			"w:%.f|h:%.f|x:%.f|y:%.f|g:%d|vis:%c|name:%.16s|children:%d",
+			indent,
 			c == get_focused_view(&root_container) ? 'K':
 			c == get_focused_container(&root_container) ? 'F' : // Focused
 			c == swayc_active_workspace() ? 'W' : // active workspace
 			c == &root_container  ? 'R' : // root
-			'X');// not any others
-	fprintf(stderr,"(%p)",c);
-	fprintf(stderr,"(p:%p)",c->parent);
-	fprintf(stderr,"(f:%p)",c->focused);
-	fprintf(stderr,"(h:%ld)",c->handle);
-	fprintf(stderr,"Type:");
-	fprintf(stderr,
-			c->type == C_ROOT   ? "Root|" :
-			c->type == C_OUTPUT ? "Output|" :
-			c->type == C_WORKSPACE ? "Workspace|" :
-			c->type == C_CONTAINER ? "Container|" :
-			c->type == C_VIEW   ? "View|" : "Unknown|");
-	fprintf(stderr,"layout:");
-	fprintf(stderr,
-			c->layout == L_NONE ? "NONE|" :
-			c->layout == L_HORIZ ? "Horiz|":
-			c->layout == L_VERT ? "Vert|":
-			c->layout == L_STACKED  ? "Stacked|":
-			c->layout == L_FLOATING ? "Floating|":
-			"Unknown|");
-	fprintf(stderr, "w:%.f|h:%.f|", c->width, c->height);
-	fprintf(stderr, "x:%.f|y:%.f|", c->x, c->y);
-	fprintf(stderr, "g:%d|",c->gaps);
-	fprintf(stderr, "vis:%c|", c->visible?'t':'f');
-	fprintf(stderr, "name:%.16s|", c->name);
-	fprintf(stderr, "children:%d\n",c->children?c->children->length:0);
+			'X', // not any others
+			c, c->parent, c->focused, c->handle,
+			c->type == C_ROOT   ? "Root" :
+			c->type == C_OUTPUT ? "Output" :
+			c->type == C_WORKSPACE ? "Workspace" :
+			c->type == C_CONTAINER ? "Container" :
+			c->type == C_VIEW   ? "View" : "Unknown",
+			c->layout == L_NONE ? "NONE" :
+			c->layout == L_HORIZ ? "Horiz":
+			c->layout == L_VERT ? "Vert":
+			c->layout == L_STACKED  ? "Stacked":
+			c->layout == L_FLOATING ? "Floating":
+			"Unknown",
+			c->width, c->height, c->x, c->y, c->gaps,
+			c->visible ? 't' : 'f', c->name,
+			c->children ? c->children->length : 0);
 }
-void layout_log(const swayc_t *c, int depth) {
-	if (L_DEBUG > v) return;
-	int i, d;
-	int e = c->children ? c->children->length : 0;
-	container_log(c);
-	if (e) {
-		for (i = 0; i < e; ++i) {
-			fputc('|',stderr);
-			for (d = 0; d < depth; ++d) fputc('-', stderr);
-			layout_log(c->children->items[i], depth + 1);
+static void pool_log(void) {
+	enum swayc_types type;
+	for (type = C_OUTPUT; type < C_TYPES; ++type) {
+		const struct swayc_pool_stats *stats = swayc_pool_stats(type);
+		sway_log(L_DEBUG, "pool:%s|live:%d|cached:%d|allocated:%lu|reused:%lu",
+				swayc_type_string(type), stats->live, stats->cached,
+				stats->allocated, stats->reused);
+	}
+}
+
+// Logs c and its descendants, each line indented with '|' and a branch
+// character per level
+static void layout_log_r(const swayc_t *c, int depth, char branch) {
+	int i;
+	char indent[depth + 1];
+	if (depth > 0) {
+		indent[0] = '|';
+		memset(indent + 1, branch, depth - 1);
+	}
+	indent[depth] = '\0';
+	container_log(c, indent);
+	if (c->children) {
+		for (i = 0; i < c->children->length; ++i) {
+			swayc_t *child = c->children->items[i];
+			sway_assert(child->index == i, "Container index drifted");
+			layout_log_r(child, depth + 1, '-');
 		}
 	}
-	if (c->type == C_WORKSPACE) {
-		e = c->floating?c->floating->length:0;
-		if (e) {
-			for (i = 0; i < e; ++i) {
-				fputc('|',stderr);
-				for (d = 0; d < depth; ++d) fputc('=', stderr);
-				layout_log(c->floating->items[i], depth + 1);
-			}
+	if (c->type == C_WORKSPACE && c->floating) {
+		for (i = 0; i < c->floating->length; ++i) {
+			swayc_t *child = c->floating->items[i];
+			sway_assert(child->index == i, "Container index drifted");
+			layout_log_r(child, depth + 1, '=');
 		}
 	}
 }
 
+void layout_log(const swayc_t *c, int depth) {
+	if (L_DEBUG > loglevel) return;
+	if (depth == 0) {
+		pool_log();
+		sway_log(L_DEBUG, "arrange|requested:%lu|executed:%lu",
+				layout_stats.arrange_requested, layout_stats.arrange_executed);
+		sway_log(L_DEBUG, "geometry|sent:%lu|skipped:%lu",
+				layout_stats.geometry_sent, layout_stats.geometry_skipped);
+		sway_log(L_DEBUG, "transaction|count:%lu|views:%lu|compute_usec:%lu|compute_max_usec:%lu",
+				layout_stats.transactions, layout_stats.transaction_views,
+				layout_stats.transaction_compute_usec, layout_stats.transaction_compute_max_usec);
+	}
+	layout_log_r(c, depth, '-');
+}
+
 const char *swayc_type_string(enum swayc_types type) {
 	return type == C_ROOT ? "ROOT" :
 		type == C_OUTPUT ? "OUTPUT" :
@@ -84,6 +103,9 @@ const char *swayc_type_string(enum swayc_types type) {
 
 // Like sway_log, but also appends some info about given container to log output.
 void swayc_log(log_importance_t verbosity, swayc_t *cont, const char* format, ...) {
+	if (verbosity > SWAY_MAX_LOG_LEVEL || verbosity > loglevel) {
+		return;
+	}
 	sway_assert(cont, "swayc_log: no container ...");
 	va_list args;
 	va_start(args, format);
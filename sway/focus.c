@@ -7,6 +7,7 @@
 #include "config.h"
 #include "input_state.h"
 #include "ipc.h"
+#include "flight.h"
 
 bool locked_container_focus = false;
 bool locked_view_focus = false;
@@ -20,6 +21,7 @@ static void update_focus(swayc_t *c) {
 		swayc_t *prev = parent->focused;
 		// Set new focus
 		parent->focused = c;
+		flight_record(FLIGHT_FOCUS, c, c->name);
 
 		switch (c->type) {
 		// Shouldnt happen
@@ -40,13 +42,20 @@ static void update_focus(swayc_t *c) {
 			}
 			// Update visibility of newly focused workspace
 			update_visibility(c);
+			// Hidden workspaces are not kept laid out
+			if (c->dirty) {
+				arrange_windows(c, -1, -1);
+			}
 			break;
 
 		default:
 		case C_VIEW:
 		case C_CONTAINER:
-			// TODO whatever to do when container changes
-			// for example, stacked and tabbing change stuff.
+			// Only the focused child of a tabbed or stacked container is
+			// laid out and shown
+			if (parent->layout == L_TABBED || parent->layout == L_STACKED) {
+				arrange_windows(parent, -1, -1);
+			}
 			break;
 		}
 	}
@@ -19,6 +19,8 @@
 #include "input_state.h"
 #include "resize.h"
 #include "extensions.h"
+#include "flight.h"
+#include "stats.h"
 
 // Event should be sent to client
 #define EVENT_PASSTHROUGH false
@@ -29,6 +31,7 @@
 /* Handles */
 
 static bool handle_output_created(wlc_handle output) {
+	flight_record(FLIGHT_WLC, (void *)(uintptr_t)output, "output_created");
 	swayc_t *op = new_output(output);
 
 	// Visibility mask to be able to make view invisible
@@ -48,29 +51,27 @@ static bool handle_output_created(wlc_handle output) {
 	wlc_handle prev = wlc_get_focused_output();
 	wlc_output_focus(output);
 	wlc_output_focus(prev);
+	arrange_windows_flush();
 	return true;
 }
 
 static void handle_output_destroyed(wlc_handle output) {
-	int i;
-	list_t *list = root_container.children;
-	for (i = 0; i < list->length; ++i) {
-		if (((swayc_t *)list->items[i])->handle == output) {
-			break;
-		}
-	}
-	if (i < list->length) {
-		destroy_output(list->items[i]);
+	flight_record(FLIGHT_WLC, (void *)(uintptr_t)output, "output_destroyed");
+	swayc_t *op = swayc_by_handle(output);
+	if (op && op->type == C_OUTPUT) {
+		destroy_output(op);
 	} else {
 		return;
 	}
-	if (list->length > 0) {
+	if (root_container.children->length > 0) {
 		// switch to other outputs active workspace
 		workspace_switch(((swayc_t *)root_container.children->items[0])->focused);
 	}
+	arrange_windows_flush();
 }
 
 static void handle_output_pre_render(wlc_handle output) {
+	arrange_windows_flush();
 	int i;
 	for (i = 0; i < desktop_shell.backgrounds->length; ++i) {
 		struct background_config *config = desktop_shell.backgrounds->items[i];
@@ -82,15 +83,20 @@ static void handle_output_pre_render(wlc_handle output) {
 }
 
 static void handle_output_resolution_change(wlc_handle output, const struct wlc_size *from, const struct wlc_size *to) {
+	flight_record(FLIGHT_WLC, (void *)(uintptr_t)output, "output_resolution");
 	sway_log(L_DEBUG, "Output %u resolution changed to %d x %d", (unsigned int)output, to->w, to->h);
 	swayc_t *c = swayc_by_handle(output);
-	if (!c) return;
+	if (!c) {
+		return;
+	}
 	c->width = to->w;
 	c->height = to->h;
 	arrange_windows(&root_container, -1, -1);
+	arrange_windows_flush();
 }
 
 static void handle_output_focused(wlc_handle output, bool focus) {
+	flight_record(FLIGHT_WLC, (void *)(uintptr_t)output, "output_focused");
 	swayc_t *c = swayc_by_handle(output);
 	// if for some reason this output doesnt exist, create it.
 	if (!c) {
@@ -99,9 +105,11 @@ static void handle_output_focused(wlc_handle output, bool focus) {
 	if (focus) {
 		set_focused_container(c);
 	}
+	arrange_windows_flush();
 }
 
 static bool handle_view_created(wlc_handle handle) {
+	flight_record(FLIGHT_WLC, (void *)(uintptr_t)handle, "view_created");
 	// if view is child of another view, the use that as focused container
 	wlc_handle parent = wlc_view_get_parent(handle);
 	swayc_t *focused = NULL;
@@ -173,10 +181,12 @@ static bool handle_view_created(wlc_handle handle) {
 		swayc_t *output = swayc_parent_by_type(newview, C_OUTPUT);
 		arrange_windows(output, -1, -1);
 	}
+	arrange_windows_flush();
 	return true;
 }
 
 static void handle_view_destroyed(wlc_handle handle) {
+	flight_record(FLIGHT_WLC, (void *)(uintptr_t)handle, "view_destroyed");
 	sway_log(L_DEBUG, "Destroying window %lu", handle);
 	swayc_t *view = swayc_by_handle(handle);
 
@@ -203,6 +213,7 @@ static void handle_view_destroyed(wlc_handle handle) {
 		arrange_windows(parent, -1, -1);
 	}
 	set_focused_container(get_focused_view(&root_container));
+	arrange_windows_flush();
 }
 
 static void handle_view_focus(wlc_handle view, bool focus) {
@@ -210,6 +221,7 @@ static void handle_view_focus(wlc_handle view, bool focus) {
 }
 
 static void handle_view_geometry_request(wlc_handle handle, const struct wlc_geometry *geometry) {
+	flight_record(FLIGHT_WLC, (void *)(uintptr_t)handle, "view_geometry_request");
 	sway_log(L_DEBUG, "geometry request for %ld %dx%d : %dx%d",
 			handle, geometry->origin.x, geometry->origin.y, geometry->size.w, geometry->size.h);
 	// If the view is floating, then apply the geometry.
@@ -228,9 +240,11 @@ static void handle_view_geometry_request(wlc_handle handle, const struct wlc_geo
 			arrange_windows(view->parent, -1, -1);
 		}
 	}
+	arrange_windows_flush();
 }
 
 static void handle_view_state_request(wlc_handle view, enum wlc_view_state_bit state, bool toggle) {
+	flight_record(FLIGHT_WLC, (void *)(uintptr_t)view, "view_state_request");
 	swayc_t *c = swayc_by_handle(view);
 	switch (state) {
 	case WLC_BIT_FULLSCREEN:
@@ -238,6 +252,7 @@ static void handle_view_state_request(wlc_handle view, enum wlc_view_state_bit s
 		wlc_view_set_state(view, state, toggle);
 		if (c) {
 			sway_log(L_DEBUG, "setting view %ld %s, fullscreen %d", view, c->name, toggle);
+			invalidate_layout(c);
 			arrange_windows(c->parent, -1, -1);
 			// Set it as focused window for that workspace if its going fullscreen
 			if (toggle) {
@@ -255,12 +270,14 @@ static void handle_view_state_request(wlc_handle view, enum wlc_view_state_bit s
 		sway_log(L_DEBUG, "View %p requested to be activated", c);
 		break;
 	}
-	return;
+	arrange_windows_flush();
 }
 
 
 static bool handle_key(wlc_handle view, uint32_t time, const struct wlc_modifiers *modifiers,
 		uint32_t key, enum wlc_key_state state) {
+	flight_record(FLIGHT_WLC, (void *)(uintptr_t)view,
+			state == WLC_KEY_STATE_PRESSED ? "key_pressed" : "key_released");
 
 	if (locked_view_focus && state == WLC_KEY_STATE_PRESSED) {
 		return EVENT_PASSTHROUGH;
@@ -276,40 +293,29 @@ static bool handle_key(wlc_handle view, uint32_t time, const struct wlc_modifier
 	struct wlc_modifiers no_mods = { 0, 0 };
 	uint32_t sym = tolower(wlc_keyboard_get_keysym_for_key(key, &no_mods));
 
-	int i;
-
 	if (state == WLC_KEY_STATE_PRESSED) {
 		press_key(sym, key);
 	} else { // WLC_KEY_STATE_RELEASED
 		release_key(sym, key);
 	}
 
-	for (i = 0; i < mode->bindings->length; ++i) {
-		struct sway_binding *binding = mode->bindings->items[i];
-
-		if ((modifiers->mods ^ binding->modifiers) == 0) {
-			bool match = false;
-			int j;
-			for (j = 0; j < binding->keys->length; ++j) {
-				xkb_keysym_t *key = binding->keys->items[j];
-				if ((match = check_key(*key, 0)) == false) {
-					break;
-				}
-			}
-			if (match) {
-				if (state == WLC_KEY_STATE_PRESSED) {
-					struct cmd_results *res = handle_command(binding->command);
-					if (res->status != CMD_SUCCESS) {
-						sway_log(L_ERROR, "Command '%s' failed: %s", res->input, res->error);
-					}
-					free_cmd_results(res);
-					return EVENT_HANDLED;
-				} else if (state == WLC_KEY_STATE_RELEASED) {
-					// TODO: --released
-				}
+	struct sway_binding *binding = get_pressed_binding(mode, modifiers->mods);
+	if (binding) {
+		if (state == WLC_KEY_STATE_PRESSED) {
+			struct cmd_results *res = binding->compiled
+				? handle_compiled_command(binding->compiled)
+				: handle_command(binding->command);
+			if (res->status != CMD_SUCCESS) {
+				sway_log(L_ERROR, "Command '%s' failed: %s", res->input, res->error);
 			}
+			free_cmd_results(res);
+			arrange_windows_flush();
+			return EVENT_HANDLED;
+		} else if (state == WLC_KEY_STATE_RELEASED) {
+			// TODO: --released
 		}
 	}
+	arrange_windows_flush();
 	return EVENT_PASSTHROUGH;
 }
 
@@ -362,12 +368,15 @@ static bool handle_pointer_motion(wlc_handle handle, uint32_t time, const struct
 	}
 
 	pointer_position_set(&new_origin, false);
+	arrange_windows_flush();
 	return EVENT_PASSTHROUGH;
 }
 
 
 static bool handle_pointer_button(wlc_handle view, uint32_t time, const struct wlc_modifiers *modifiers,
 		uint32_t button, enum wlc_button_state state, const struct wlc_point *origin) {
+	flight_record(FLIGHT_WLC, (void *)(uintptr_t)view,
+			state == WLC_BUTTON_STATE_PRESSED ? "button_pressed" : "button_released");
 
 	// Update view pointer is on
 	pointer_state.view = container_under_pointer();
@@ -434,17 +443,11 @@ static bool handle_pointer_button(wlc_handle view, uint32_t time, const struct w
 		}
 		// Send to front if floating
 		if (pointer->is_floating) {
-			int i;
-			for (i = 0; i < pointer->parent->floating->length; i++) {
-				if (pointer->parent->floating->items[i] == pointer) {
-					list_del(pointer->parent->floating, i);
-					list_add(pointer->parent->floating, pointer);
-					break;
-				}
-			}
+			raise_floating(pointer);
 			wlc_view_bring_to_front(pointer->handle);
 		}
 	}
+	arrange_windows_flush();
 
 	// Return if mode has been set
 	if (pointer_state.mode) {
@@ -461,6 +464,7 @@ static bool handle_pointer_button(wlc_handle view, uint32_t time, const struct w
 }
 
 static void handle_wlc_ready(void) {
+	flight_record(FLIGHT_WLC, NULL, "ready");
 	sway_log(L_DEBUG, "Compositor is ready, executing cmds in queue");
 	// Execute commands until there are none left
 	config->active = true;
@@ -474,33 +478,115 @@ static void handle_wlc_ready(void) {
 		free(line);
 		list_del(config->cmd_queue, 0);
 	}
+	arrange_windows_flush();
+}
+
+/* Timing shims, so every exit of a handler is measured */
+
+static bool timed_output_created(wlc_handle output) {
+	uint64_t start = stats_begin();
+	bool ret = handle_output_created(output);
+	stats_record(STATS_OUTPUT_CREATED, start);
+	return ret;
+}
+
+static void timed_output_destroyed(wlc_handle output) {
+	uint64_t start = stats_begin();
+	handle_output_destroyed(output);
+	stats_record(STATS_OUTPUT_DESTROYED, start);
+}
+
+static void timed_output_pre_render(wlc_handle output) {
+	uint64_t start = stats_begin();
+	handle_output_pre_render(output);
+	stats_record(STATS_OUTPUT_PRE_RENDER, start);
+}
+
+static void timed_output_resolution_change(wlc_handle output, const struct wlc_size *from, const struct wlc_size *to) {
+	uint64_t start = stats_begin();
+	handle_output_resolution_change(output, from, to);
+	stats_record(STATS_OUTPUT_RESOLUTION, start);
+}
+
+static void timed_output_focused(wlc_handle output, bool focus) {
+	uint64_t start = stats_begin();
+	handle_output_focused(output, focus);
+	stats_record(STATS_OUTPUT_FOCUS, start);
+}
+
+static bool timed_view_created(wlc_handle handle) {
+	uint64_t start = stats_begin();
+	bool ret = handle_view_created(handle);
+	stats_record(STATS_VIEW_CREATED, start);
+	return ret;
+}
+
+static void timed_view_destroyed(wlc_handle handle) {
+	uint64_t start = stats_begin();
+	handle_view_destroyed(handle);
+	stats_record(STATS_VIEW_DESTROYED, start);
+}
+
+static void timed_view_geometry_request(wlc_handle handle, const struct wlc_geometry *geometry) {
+	uint64_t start = stats_begin();
+	handle_view_geometry_request(handle, geometry);
+	stats_record(STATS_VIEW_GEOMETRY_REQUEST, start);
+}
+
+static void timed_view_state_request(wlc_handle view, enum wlc_view_state_bit state, bool toggle) {
+	uint64_t start = stats_begin();
+	handle_view_state_request(view, state, toggle);
+	stats_record(STATS_VIEW_STATE_REQUEST, start);
+}
+
+static bool timed_key(wlc_handle view, uint32_t time, const struct wlc_modifiers *modifiers,
+		uint32_t key, enum wlc_key_state state) {
+	uint64_t start = stats_begin();
+	bool ret = handle_key(view, time, modifiers, key, state);
+	stats_record(STATS_KEY, start);
+	return ret;
+}
+
+static bool timed_pointer_motion(wlc_handle handle, uint32_t time, const struct wlc_point *origin) {
+	uint64_t start = stats_begin();
+	bool ret = handle_pointer_motion(handle, time, origin);
+	stats_record(STATS_POINTER_MOTION, start);
+	return ret;
+}
+
+static bool timed_pointer_button(wlc_handle view, uint32_t time, const struct wlc_modifiers *modifiers,
+		uint32_t button, enum wlc_button_state state, const struct wlc_point *origin) {
+	uint64_t start = stats_begin();
+	bool ret = handle_pointer_button(view, time, modifiers, button, state, origin);
+	stats_record(STATS_POINTER_BUTTON, start);
+	return ret;
 }
 
 struct wlc_interface interface = {
 	.output = {
-		.created = handle_output_created,
-		.destroyed = handle_output_destroyed,
-		.resolution = handle_output_resolution_change,
-		.focus = handle_output_focused,
+		.created = timed_output_created,
+		.destroyed = timed_output_destroyed,
+		.resolution = timed_output_resolution_change,
+		.focus = timed_output_focused,
 		.render = {
-			.pre = handle_output_pre_render
+			.pre = timed_output_pre_render
 		}
 	},
 	.view = {
-		.created = handle_view_created,
-		.destroyed = handle_view_destroyed,
+		.created = timed_view_created,
+		.destroyed = timed_view_destroyed,
 		.focus = handle_view_focus,
 		.request = {
-			.geometry = handle_view_geometry_request,
-			.state = handle_view_state_request
+			.geometry = timed_view_geometry_request,
+			.state = timed_view_state_request
 		}
 	},
 	.keyboard = {
-		.key = handle_key
+		.key = timed_key
 	},
 	.pointer = {
-		.motion = handle_pointer_motion,
-		.button = handle_pointer_button
+		.motion = timed_pointer_motion,
+		.button = timed_pointer_button
 	},
 	.compositor = {
 		.ready = handle_wlc_ready
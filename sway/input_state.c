@@ -1,13 +1,13 @@
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <ctype.h>
 #include "log.h"
 #include "config.h"
 
 #include "input_state.h"
 
-#define KEY_STATE_MAX_LENGTH 64
-
 struct key_state {
 	/*
 	 * Aims to store state regardless of modifiers.
@@ -16,63 +16,147 @@ struct key_state {
 	 * that scenario and makes sure we can use the right bindings.
 	 */
 	uint32_t key_sym;
-	uint32_t alt_sym;
 	uint32_t key_code;
 };
 
-static struct key_state key_state_array[KEY_STATE_MAX_LENGTH];
+// Pressed keys, in the order they were pressed
+static struct key_state *key_states = NULL;
+static int key_states_length = 0, key_states_capacity = 0;
+
+// Bitset of the pressed key codes
+static uint32_t *key_codes = NULL;
+static uint32_t key_codes_words = 0;
+
+// Maps each keysym of the pressed keys to the number of keys it matches
+static hash_t *key_syms = NULL;
 
 void input_init(void) {
-	int i;
-	for (i = 0; i < KEY_STATE_MAX_LENGTH; ++i) {
-		struct key_state none = { 0, 0, 0 };
-		key_state_array[i] = none;
+	key_states_length = 0;
+	memset(key_codes, 0, key_codes_words * sizeof(*key_codes));
+	if (key_syms) {
+		hash_free(key_syms);
 	}
+	key_syms = create_hash();
 }
 
-static uint8_t find_key(uint32_t key_sym, uint32_t key_code, bool update) {
-	int i;
-	for (i = 0; i < KEY_STATE_MAX_LENGTH; ++i) {
-		if (0 == key_sym && 0 == key_code && key_state_array[i].key_sym == 0) {
-			break;
+static void ref_sym(uint32_t key_sym) {
+	if (key_sym) {
+		uintptr_t refs = (uintptr_t)hash_get(key_syms, key_sym);
+		hash_set(key_syms, key_sym, (void *)(refs + 1));
+	}
+}
+
+static void unref_sym(uint32_t key_sym) {
+	if (key_sym) {
+		uintptr_t refs = (uintptr_t)hash_get(key_syms, key_sym);
+		if (refs > 1) {
+			hash_set(key_syms, key_sym, (void *)(refs - 1));
+		} else {
+			hash_del(key_syms, key_sym);
 		}
-		if (key_state_array[i].key_sym == key_sym
-			|| key_state_array[i].alt_sym == key_sym) {
-			break;
+	}
+}
+
+static bool check_code(uint32_t key_code) {
+	uint32_t word = key_code / 32;
+	return word < key_codes_words && key_codes[word] & (1u << key_code % 32);
+}
+
+static void set_code(uint32_t key_code, bool pressed) {
+	uint32_t word = key_code / 32;
+	if (word >= key_codes_words) {
+		if (!pressed) {
+			return;
 		}
-		if (update && key_state_array[i].key_code == key_code) {
-			key_state_array[i].alt_sym = key_sym;
-			break;
+		uint32_t words = word + 1;
+		uint32_t *codes = realloc(key_codes, words * sizeof(*codes));
+		if (!codes) {
+			sway_log(L_ERROR, "Unable to track key code %u", key_code);
+			return;
 		}
+		memset(codes + key_codes_words, 0, (words - key_codes_words) * sizeof(*codes));
+		key_codes = codes;
+		key_codes_words = words;
+	}
+	if (pressed) {
+		key_codes[word] |= 1u << key_code % 32;
+	} else {
+		key_codes[word] &= ~(1u << key_code % 32);
 	}
-	return i;
 }
 
 bool check_key(uint32_t key_sym, uint32_t key_code) {
-	return find_key(key_sym, key_code, false) < KEY_STATE_MAX_LENGTH;
+	return hash_get(key_syms, key_sym) != NULL;
 }
 
 void press_key(uint32_t key_sym, uint32_t key_code) {
-	if (key_code == 0) {
+	if (key_code == 0 || check_key(key_sym, key_code)) {
 		return;
 	}
-	// Check if key exists
-	if (!check_key(key_sym, key_code)) {
-		// Check that we dont exceed buffer length
-		int insert = find_key(0, 0, true);
-		if (insert < KEY_STATE_MAX_LENGTH) {
-			key_state_array[insert].key_sym = key_sym;
-			key_state_array[insert].key_code = key_code;
+	if (key_states_length == key_states_capacity) {
+		int capacity = key_states_capacity ? key_states_capacity * 2 : 16;
+		struct key_state *states = realloc(key_states, capacity * sizeof(*states));
+		if (!states) {
+			sway_log(L_ERROR, "Unable to track pressed key %u", key_code);
+			return;
 		}
+		key_states = states;
+		key_states_capacity = capacity;
 	}
+	struct key_state *state = &key_states[key_states_length++];
+	state->key_sym = key_sym;
+	state->key_code = key_code;
+	ref_sym(key_sym);
+	set_code(key_code, true);
 }
 
 void release_key(uint32_t key_sym, uint32_t key_code) {
-	uint8_t index = find_key(key_sym, key_code, true);
-	if (index < KEY_STATE_MAX_LENGTH) {
-		struct key_state none = { 0, 0, 0 };
-		key_state_array[index] = none;
+	if (!check_key(key_sym, key_code) && !check_code(key_code)) {
+		return;
+	}
+	// Same key, whichever sym it was pressed with
+	int i;
+	for (i = 0; i < key_states_length; ++i) {
+		struct key_state *state = &key_states[i];
+		if (state->key_sym == key_sym || state->key_code == key_code) {
+			break;
+		}
+	}
+	if (i == key_states_length) {
+		return;
+	}
+	struct key_state released = key_states[i];
+	memmove(&key_states[i], &key_states[i + 1],
+			(key_states_length - i - 1) * sizeof(*key_states));
+	--key_states_length;
+	unref_sym(released.key_sym);
+	// The code may still be held under another sym
+	for (i = 0; i < key_states_length; ++i) {
+		if (key_states[i].key_code == released.key_code) {
+			return;
+		}
+	}
+	set_code(released.key_code, false);
+}
+
+const uint32_t *pressed_keysyms(int *count) {
+	static uint32_t *syms = NULL;
+	static int capacity = 0;
+	if (capacity < key_states_capacity) {
+		uint32_t *buf = realloc(syms, key_states_capacity * sizeof(*buf));
+		if (!buf) {
+			*count = 0;
+			return syms;
+		}
+		syms = buf;
+		capacity = key_states_capacity;
+	}
+	int i;
+	for (i = 0; i < key_states_length; ++i) {
+		syms[i] = key_states[i].key_sym;
 	}
+	*count = key_states_length;
+	return syms;
 }
 
 // Pointer state and mode
@@ -333,8 +417,10 @@ void pointer_mode_update(void) {
 			// Swap them around
 			swap_container(pointer_state.view, initial.ptr);
 			swap_geometry(pointer_state.view, initial.ptr);
+			layout_transaction_begin();
 			update_geometry(pointer_state.view);
 			update_geometry(initial.ptr);
+			layout_transaction_commit();
 			// Set focus back to initial view
 			set_focused_container(initial.ptr);
 		}
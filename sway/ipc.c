@@ -1,5 +1,6 @@
 // See https://i3wm.org/docs/ipc.html for protocol information
 
+#include <assert.h>
 #include <errno.h>
 #include <string.h>
 #include <sys/socket.h>
@@ -19,6 +20,9 @@
 #include "commands.h"
 #include "list.h"
 #include "stringop.h"
+#include "layout.h"
+#include "stats.h"
+#include "trace.h"
 
 static int ipc_socket = -1;
 static struct wlc_event_source *ipc_event_source =  NULL;
@@ -170,7 +174,9 @@ int ipc_client_handle_readable(int client_fd, uint32_t mask, void *data) {
 	// Wait for the rest of the command payload in case the header has already been read
 	if (client->payload_length > 0) {
 		if ((uint32_t)read_available >= client->payload_length) {
+			uint64_t start = trace_begin();
 			ipc_client_handle_command(client);
+			trace_end("ipc_command", "ipc", start);
 		}
 		return 0;
 	}
@@ -198,7 +204,9 @@ int ipc_client_handle_readable(int client_fd, uint32_t mask, void *data) {
 	client->current_command = (enum ipc_command_type)buf32[1];
 
 	if (read_available - received >= client->payload_length) {
+		uint64_t start = trace_begin();
 		ipc_client_handle_command(client);
+		trace_end("ipc_command", "ipc", start);
 	}
 
 	return 0;
@@ -266,11 +274,15 @@ void ipc_client_handle_command(struct ipc_client *client) {
 		}
 	}
 
+	// Replies should see the tree as laid out
+	arrange_windows_flush();
+
 	switch (client->current_command) {
 	case IPC_COMMAND:
 	{
 		buf[client->payload_length] = '\0';
 		struct cmd_results *results = handle_command(buf);
+		arrange_windows_flush();
 		const char *json = cmd_results_to_json(results);
 		char reply[256];
 		int length = snprintf(reply, sizeof(reply), "%s", json);
@@ -312,7 +324,12 @@ void ipc_client_handle_command(struct ipc_client *client) {
 	case IPC_GET_WORKSPACES:
 	{
 		json_object *workspaces = json_object_new_array();
-		container_map(&root_container, ipc_get_workspaces_callback, workspaces);
+		struct swayc_iter iter;
+		swayc_iter_init(&iter, &root_container, C_WORKSPACE);
+		swayc_t *container;
+		while ((container = swayc_iter_next(&iter))) {
+			ipc_get_workspaces_callback(container, workspaces);
+		}
 		const char *json_string = json_object_to_json_string(workspaces);
 		ipc_send_reply(client, json_string, (uint32_t) strlen(json_string));
 		json_object_put(workspaces); // free
@@ -321,7 +338,12 @@ void ipc_client_handle_command(struct ipc_client *client) {
 	case IPC_GET_OUTPUTS:
 	{
 		json_object *outputs = json_object_new_array();
-		container_map(&root_container, ipc_get_outputs_callback, outputs);
+		struct swayc_iter iter;
+		swayc_iter_init(&iter, &root_container, C_OUTPUT);
+		swayc_t *container;
+		while ((container = swayc_iter_next(&iter))) {
+			ipc_get_outputs_callback(container, outputs);
+		}
 		const char *json_string = json_object_to_json_string(outputs);
 		ipc_send_reply(client, json_string, (uint32_t) strlen(json_string));
 		json_object_put(outputs); // free
@@ -360,7 +382,14 @@ void ipc_client_handle_command(struct ipc_client *client) {
 		char response_header[9];
 		memset(response_header, 0, sizeof(response_header));
 		buf[client->payload_length] = '\0';
-		swayc_t *output = swayc_by_test(&root_container, output_by_name_test, buf);
+		swayc_t *output;
+		struct swayc_iter iter;
+		swayc_iter_init(&iter, &root_container, C_OUTPUT);
+		while ((output = swayc_iter_next(&iter))) {
+			if (output_by_name_test(output, buf)) {
+				break;
+			}
+		}
 		if (!output) {
 			sway_log(L_ERROR, "IPC GET_PIXELS request with unknown output name");
 			ipc_send_reply(client, response_header, sizeof(response_header));
@@ -369,6 +398,14 @@ void ipc_client_handle_command(struct ipc_client *client) {
 		wlc_output_get_pixels(output->handle, get_pixels_callback, client);
 		break;
 	}
+	case IPC_SWAY_GET_STATS:
+	{
+		json_object *stats = stats_json();
+		const char *json_string = json_object_to_json_string(stats);
+		ipc_send_reply(client, json_string, (uint32_t) strlen(json_string));
+		json_object_put(stats); // free
+		break;
+	}
 	default:
 		sway_log(L_INFO, "Unknown IPC command type %i", client->current_command);
 		ipc_client_disconnect(client);
@@ -9,6 +9,10 @@
 #include "workspace.h"
 #include "focus.h"
 #include "output.h"
+#include "flight.h"
+#include "clock.h"
+#include "stats.h"
+#include "trace.h"
 
 swayc_t root_container;
 list_t *scratchpad;
@@ -16,6 +20,79 @@ list_t *scratchpad;
 int min_sane_h = 60;
 int min_sane_w = 100;
 
+struct layout_stats layout_stats;
+
+// Container to lay out on the next arrange_windows_flush, the common ancestor
+// of everything passed to arrange_windows since the last flush
+static swayc_t *pending_arrange = NULL;
+
+// View geometry computed while a layout transaction is open, sent to the
+// clients when it is committed
+static struct {
+	struct pending_geometry {
+		wlc_handle handle;
+		struct wlc_geometry geometry;
+	} *items;
+	int length, capacity;
+	int depth;
+	uint64_t start;
+} transaction;
+
+void layout_transaction_begin(void) {
+	if (transaction.depth++ == 0) {
+		transaction.start = clock_now_ns();
+	}
+}
+
+static void queue_geometry(wlc_handle handle, const struct wlc_geometry *geometry) {
+	if (transaction.length == transaction.capacity) {
+		int capacity = transaction.capacity ? transaction.capacity * 2 : 16;
+		struct pending_geometry *items = realloc(transaction.items, capacity * sizeof(*items));
+		if (!items) {
+			sway_log(L_ERROR, "Unable to grow layout transaction");
+			wlc_view_set_geometry(handle, 0, geometry);
+			return;
+		}
+		transaction.items = items;
+		transaction.capacity = capacity;
+	}
+	transaction.items[transaction.length].handle = handle;
+	transaction.items[transaction.length].geometry = *geometry;
+	++transaction.length;
+}
+
+void layout_transaction_commit(void) {
+	if (!sway_assert(transaction.depth > 0, "No layout transaction to commit")
+			|| --transaction.depth > 0) {
+		return;
+	}
+	int i;
+	for (i = 0; i < transaction.length; ++i) {
+		struct pending_geometry *pending = &transaction.items[i];
+		wlc_view_set_geometry(pending->handle, 0, &pending->geometry);
+	}
+	unsigned long usec = (clock_now_ns() - transaction.start) / 1000;
+	++layout_stats.transactions;
+	layout_stats.transaction_views += transaction.length;
+	layout_stats.transaction_compute_usec += usec;
+	if (usec > layout_stats.transaction_compute_max_usec) {
+		layout_stats.transaction_compute_max_usec = usec;
+	}
+	sway_log(L_DEBUG, "Layout transaction computed and sent %d geometries in %luus",
+			transaction.length, usec);
+	transaction.length = 0;
+}
+
+// Returns true if ancestor is container or one of its ancestors
+static bool is_ancestor_or_self(swayc_t *ancestor, swayc_t *container) {
+	for (; container; container = container->parent) {
+		if (container == ancestor) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void init_layout(void) {
 	root_container.type = C_ROOT;
 	root_container.layout = L_NONE;
@@ -25,25 +102,59 @@ void init_layout(void) {
 	scratchpad = create_list();
 }
 
-int index_child(const swayc_t *child) {
-	swayc_t *parent = child->parent;
-	int i, len;
-	if (!child->is_floating) {
-		len = parent->children->length;
-		for (i = 0; i < len; ++i) {
-			if (parent->children->items[i] == child) {
-				break;
-			}
-		}
+// Updates the stored index of the containers in list, starting at index
+static void reindex_children(list_t *list, int index) {
+	for (; index < list->length; ++index) {
+		((swayc_t *)list->items[index])->index = index;
+	}
+}
+
+// Recomputes the cached output and workspace of container and its descendants
+// after container has been reparented. This also marks them for arranging, as
+// their geometry depends on where they live.
+static void update_ancestors(swayc_t *container) {
+	swayc_t *parent = container->parent;
+	container->dirty = true;
+	if (parent) {
+		container->output = parent->type == C_OUTPUT ? parent : parent->output;
+		container->workspace = parent->type == C_WORKSPACE ? parent : parent->workspace;
 	} else {
-		len = parent->floating->length;
-		for (i = 0; i < len; ++i) {
-			if (parent->floating->items[i] == child) {
-				break;
-			}
+		container->output = NULL;
+		container->workspace = NULL;
+	}
+	int i;
+	if (container->children) {
+		for (i = 0; i < container->children->length; ++i) {
+			update_ancestors(container->children->items[i]);
+		}
+	}
+	if (container->floating) {
+		for (i = 0; i < container->floating->length; ++i) {
+			update_ancestors(container->floating->items[i]);
 		}
 	}
-	if (!sway_assert(i < len, "Stray container")) {
+}
+
+#ifdef SWAY_DEBUG_INDEXES
+// Checks that every container in list is stored at its index, so a missed
+// reindex fails at the mutation that caused it
+static void assert_indexes(list_t *list) {
+	int i;
+	for (i = 0; i < list->length; ++i) {
+		swayc_t *c = list->items[i];
+		sway_assert(c->index == i, "Container %p at %d has index %d", c, i, c->index);
+	}
+}
+#else
+#define assert_indexes(list)
+#endif
+
+int index_child(const swayc_t *child) {
+	swayc_t *parent = child->parent;
+	list_t *list = child->is_floating ? parent->floating : parent->children;
+	int i = child->index;
+	if (!sway_assert(i >= 0 && i < list->length && list->items[i] == child,
+				"Stray container")) {
 		return -1;
 	}
 	return i;
@@ -52,8 +163,12 @@ int index_child(const swayc_t *child) {
 void add_child(swayc_t *parent, swayc_t *child) {
 	sway_log(L_DEBUG, "Adding %p (%d, %fx%f) to %p (%d, %fx%f)", child, child->type,
 		child->width, child->height, parent, parent->type, parent->width, parent->height);
+	child->index = parent->children->length;
 	list_add(parent->children, child);
+	assert_indexes(parent->children);
 	child->parent = parent;
+	update_ancestors(child);
+	invalidate_layout(parent);
 	// set focus for this container
 	if (!parent->focused) {
 		parent->focused = child;
@@ -68,7 +183,11 @@ void insert_child(swayc_t *parent, swayc_t *child, int index) {
 		index = 0;
 	}
 	list_insert(parent->children, index, child);
+	reindex_children(parent->children, index);
+	assert_indexes(parent->children);
 	child->parent = parent;
+	update_ancestors(child);
+	invalidate_layout(parent);
 	if (!parent->focused) {
 		parent->focused = child;
 	}
@@ -80,9 +199,14 @@ void add_floating(swayc_t *ws, swayc_t *child) {
 	if (!sway_assert(ws->type == C_WORKSPACE, "Must be of workspace type")) {
 		return;
 	}
+	child->index = ws->floating->length;
 	list_add(ws->floating, child);
+	assert_indexes(ws->floating);
 	child->parent = ws;
+	update_ancestors(child);
+	invalidate_layout(ws);
 	child->is_floating = true;
+	floating_index_update(child);
 	if (!ws->focused) {
 		ws->focused = child;
 	}
@@ -92,7 +216,11 @@ swayc_t *add_sibling(swayc_t *sibling, swayc_t *child) {
 	swayc_t *parent = sibling->parent;
 	int i = index_child(sibling);
 	list_insert(parent->children, i+1, child);
+	reindex_children(parent->children, i+1);
+	assert_indexes(parent->children);
 	child->parent = parent;
+	update_ancestors(child);
+	invalidate_layout(parent);
 	return child->parent;
 }
 
@@ -103,13 +231,21 @@ swayc_t *replace_child(swayc_t *child, swayc_t *new_child) {
 	}
 	int i = index_child(child);
 	parent->children->items[i] = new_child;
+	new_child->index = i;
+	assert_indexes(parent->children);
 
 	// Set parent and focus for new_child
 	new_child->parent = child->parent;
+	update_ancestors(new_child);
+	invalidate_layout(parent);
+	if (is_ancestor_or_self(child, pending_arrange)) {
+		pending_arrange = parent;
+	}
 	if (child->parent->focused == child) {
 		child->parent->focused = new_child;
 	}
 	child->parent = NULL;
+	update_ancestors(child);
 
 	// Set geometry for new child
 	new_child->x = child->x;
@@ -128,25 +264,44 @@ swayc_t *replace_child(swayc_t *child, swayc_t *new_child) {
 	return parent;
 }
 
+void move_children(swayc_t *source, swayc_t *parent) {
+	list_t *children = source->children;
+	if (children->length == 0) {
+		return;
+	}
+	int i, start = parent->children->length;
+	list_splice(parent->children, start, children, 0, children->length);
+	list_remove_range(children, 0, children->length);
+	source->focused = NULL;
+	for (i = start; i < parent->children->length; ++i) {
+		swayc_t *child = parent->children->items[i];
+		child->index = i;
+		child->parent = parent;
+		update_ancestors(child);
+	}
+	assert_indexes(parent->children);
+	if (is_ancestor_or_self(source, pending_arrange)) {
+		pending_arrange = parent;
+	}
+	invalidate_layout(source);
+	invalidate_layout(parent);
+	if (!parent->focused) {
+		parent->focused = parent->children->items[start];
+	}
+}
+
 swayc_t *remove_child(swayc_t *child) {
-	int i;
 	swayc_t *parent = child->parent;
-	if (child->is_floating) {
-		// Special case for floating views
-		for (i = 0; i < parent->floating->length; ++i) {
-			if (parent->floating->items[i] == child) {
-				list_del(parent->floating, i);
-				break;
-			}
-		}
+	list_t *list = child->is_floating ? parent->floating : parent->children;
+	int i = index_child(child);
+	if (i >= 0) {
+		list_del(list, i);
+		reindex_children(list, i);
+		assert_indexes(list);
+	}
+	// Special case for floating views
+	if (child->is_floating || i < 0) {
 		i = 0;
-	} else {
-		for (i = 0; i < parent->children->length; ++i) {
-			if (parent->children->items[i] == child) {
-				list_del(parent->children, i);
-				break;
-			}
-		}
 	}
 	// Set focused to new container
 	if (parent->focused == child) {
@@ -158,7 +313,16 @@ swayc_t *remove_child(swayc_t *child) {
 			parent->focused = NULL;
 		}
 	}
+	if (child->is_floating) {
+		floating_index_remove(child);
+	}
+	// Arrange the old parent instead of the detached subtree
+	if (is_ancestor_or_self(child, pending_arrange)) {
+		pending_arrange = parent;
+	}
 	child->parent = NULL;
+	update_ancestors(child);
+	invalidate_layout(parent);
 	// deactivate view
 	if (child->type == C_VIEW) {
 		wlc_view_set_state(child->handle, WLC_BIT_ACTIVATED, false);
@@ -179,8 +343,16 @@ void swap_container(swayc_t *a, swayc_t *b) {
 	// Swap the pointers
 	a_parent->children->items[a_index] = b;
 	b_parent->children->items[b_index] = a;
+	a->index = b_index;
+	b->index = a_index;
+	assert_indexes(a_parent->children);
+	assert_indexes(b_parent->children);
 	a->parent = b_parent;
 	b->parent = a_parent;
+	update_ancestors(a);
+	update_ancestors(b);
+	invalidate_layout(a_parent);
+	invalidate_layout(b_parent);
 	if (a_parent->focused == a) {
 		a_parent->focused = b;
 	}
@@ -190,6 +362,50 @@ void swap_container(swayc_t *a, swayc_t *b) {
 	}
 }
 
+void invalidate_layout(swayc_t *container) {
+	for (; container; container = container->parent) {
+		container->dirty = true;
+	}
+}
+
+static void invalidate_descendants(swayc_t *container) {
+	int i;
+	if (container->children) {
+		for (i = 0; i < container->children->length; ++i) {
+			swayc_t *child = container->children->items[i];
+			child->dirty = true;
+			invalidate_descendants(child);
+		}
+	}
+	if (container->floating) {
+		for (i = 0; i < container->floating->length; ++i) {
+			swayc_t *child = container->floating->items[i];
+			child->dirty = true;
+			invalidate_descendants(child);
+		}
+	}
+}
+
+void invalidate_layout_r(swayc_t *container) {
+	invalidate_descendants(container);
+	invalidate_layout(container);
+}
+
+void raise_floating(swayc_t *child) {
+	swayc_t *ws = child->parent;
+	int i = index_child(child);
+	if (i < 0) {
+		return;
+	}
+	list_del(ws->floating, i);
+	list_add(ws->floating, child);
+	reindex_children(ws->floating, i);
+	assert_indexes(ws->floating);
+	// Its cells in the floating index are kept in stacking order too
+	floating_index_remove(child);
+	floating_index_update(child);
+}
+
 void swap_geometry(swayc_t *a, swayc_t *b) {
 	double x = a->x;
 	double y = a->y;
@@ -387,10 +603,42 @@ void update_geometry(swayc_t *container) {
 			geometry.size.h = ws->height - geometry.origin.y;
 		}
 	}
-	wlc_view_set_geometry(container->handle, 0, &geometry);
+	if (wlc_geometry_equals(&geometry, &container->sent_geometry)) {
+		++layout_stats.geometry_skipped;
+	} else {
+		if (transaction.depth) {
+			queue_geometry(container->handle, &geometry);
+		} else {
+			wlc_view_set_geometry(container->handle, 0, &geometry);
+		}
+		container->sent_geometry = geometry;
+		++layout_stats.geometry_sent;
+	}
+	container->arranged.x = container->x;
+	container->arranged.y = container->y;
+	container->arranged.width = container->width;
+	container->arranged.height = container->height;
+	if (container->is_floating) {
+		floating_index_update(container);
+	}
 }
 
-static void arrange_windows_r(swayc_t *container, double width, double height) {
+static void arrange_windows_r(swayc_t *container, double width, double height);
+
+// Children of tabbed and stacked containers other than the focused one are not
+// shown, so they only get their size here and are laid out once focused
+static void arrange_child(swayc_t *container, swayc_t *child, double width, double height) {
+	if ((container->layout == L_TABBED || container->layout == L_STACKED)
+			&& container->focused != child) {
+		child->width = width;
+		child->height = height;
+		child->dirty = true;
+		return;
+	}
+	arrange_windows_r(child, width, height);
+}
+
+static void arrange_container(swayc_t *container, double width, double height) {
 	int i;
 	if (width == -1 || height == -1) {
 		swayc_log(L_DEBUG, container, "Arranging layout for %p", container);
@@ -398,6 +646,21 @@ static void arrange_windows_r(swayc_t *container, double width, double height) {
 		height = container->height;
 	}
 
+	// Nothing below a clean container changes unless it is given a new
+	// geometry, so its previous layout can be kept
+	if (!container->dirty
+			&& container->x == container->arranged.x
+			&& container->y == container->arranged.y
+			&& width == container->arranged.width
+			&& height == container->arranged.height) {
+		return;
+	}
+	container->dirty = false;
+	container->arranged.x = container->x;
+	container->arranged.y = container->y;
+	container->arranged.width = width;
+	container->arranged.height = height;
+
 	sway_log(L_DEBUG, "Arranging layout for %p %s %fx%f+%f,%f", container,
 		container->name, container->width, container->height, container->x, container->y);
 
@@ -422,6 +685,11 @@ static void arrange_windows_r(swayc_t *container, double width, double height) {
 			child->y = y + gap;
 			child->width = width - gap * 2;
 			child->height = height - gap * 2;
+			if (child != container->focused) {
+				// Hidden workspaces are laid out when switched to
+				child->dirty = true;
+				continue;
+			}
 			sway_log(L_DEBUG, "Arranging workspace #%d at %f, %f", i, child->x, child->y);
 			arrange_windows_r(child, -1, -1);
 		}
@@ -467,7 +735,7 @@ static void arrange_windows_r(swayc_t *container, double width, double height) {
 				sway_log(L_DEBUG, "Calculating arrangement for %p:%d (will scale %f by %f)", child, child->type, width, scale);
 				child->x = x + container->x;
 				child->y = y + container->y;
-				arrange_windows_r(child, child->width * scale, height);
+				arrange_child(container, child, child->width * scale, height);
 				x += child->width;
 			}
 		}
@@ -494,7 +762,7 @@ static void arrange_windows_r(swayc_t *container, double width, double height) {
 				sway_log(L_DEBUG, "Calculating arrangement for %p:%d (will scale %f by %f)", child, child->type, height, scale);
 				child->x = x + container->x;
 				child->y = y + container->y;
-				arrange_windows_r(child, width, child->height * scale);
+				arrange_child(container, child, width, child->height * scale);
 				y += child->height;
 			}
 		}
@@ -518,9 +786,57 @@ static void arrange_windows_r(swayc_t *container, double width, double height) {
 	}
 }
 
+static void arrange_windows_r(swayc_t *container, double width, double height) {
+	uint64_t start = trace_begin();
+	arrange_container(container, width, height);
+	trace_end(swayc_type_string(container->type), "arrange", start);
+}
+
 void arrange_windows(swayc_t *container, double width, double height) {
+	if (!container) {
+		return;
+	}
+	// Detached or freed containers must not become the pending arrange, their
+	// parent chain doesn't lead to the root
+	if (container != &root_container && !container->parent) {
+		sway_log(L_DEBUG, "Ignoring arrange of container %p, it is not in the tree", container);
+		return;
+	}
+	++layout_stats.arrange_requested;
+	if (width != -1 && height != -1) {
+		container->width = width;
+		container->height = height;
+	}
+	invalidate_layout(container);
+	if (!pending_arrange) {
+		pending_arrange = container;
+		return;
+	}
+	while (pending_arrange && !is_ancestor_or_self(pending_arrange, container)) {
+		pending_arrange = pending_arrange->parent;
+	}
+	if (!pending_arrange) {
+		// container is not in the tree
+		pending_arrange = &root_container;
+	}
+}
+
+void arrange_windows_flush(void) {
+	swayc_t *container = pending_arrange;
+	if (!container) {
+		return;
+	}
+	pending_arrange = NULL;
+	uint64_t start = stats_begin();
+	++layout_stats.arrange_executed;
+	flight_record(FLIGHT_ARRANGE, container, swayc_type_string(container->type));
+	uint64_t visibility_start = trace_begin();
 	update_visibility(container);
-	arrange_windows_r(container, width, height);
+	trace_end("update_visibility", "arrange", visibility_start);
+	layout_transaction_begin();
+	arrange_windows_r(container, -1, -1);
+	layout_transaction_commit();
+	stats_record(STATS_ARRANGE, start);
 	layout_log(&root_container, 0);
 }
 
@@ -592,6 +908,7 @@ void recursive_resize(swayc_t *container, double amount, enum wlc_resize_edge ed
 		container->height += amount;
 		layout_match = container->layout == L_VERT;
 	}
+	invalidate_layout(container);
 	if (container->type == C_VIEW) {
 		update_geometry(container);
 		return;
@@ -61,6 +61,7 @@ int main(int argc, char **argv) {
 		{"version", no_argument, NULL, 'v'},
 		{"verbose", no_argument, &verbose, 1},
 		{"get-socketpath", no_argument, NULL, 'p'},
+		{"log-file", required_argument, NULL, 'l'},
 		{0, 0, 0, 0}
 	};
 
@@ -78,11 +79,12 @@ int main(int argc, char **argv) {
 	register_extensions();
 
 	char *config_path = NULL;
+	char *log_path = NULL;
 
 	int c;
 	while (1) {
 		int option_index = 0;
-		c = getopt_long(argc, argv, "CdvVpc:", long_options, &option_index);
+		c = getopt_long(argc, argv, "CdvVpc:l:", long_options, &option_index);
 		if (c == -1) {
 			break;
 		}
@@ -92,6 +94,9 @@ int main(int argc, char **argv) {
 		case 'c': // config
 			config_path = strdup(optarg);
 			break;
+		case 'l': // log-file
+			log_path = optarg;
+			break;
 		case 'C': // validate
 			validate = 1;
 			break;
@@ -121,6 +126,9 @@ int main(int argc, char **argv) {
 		}
 	}
 
+	if (log_path) {
+		set_log_file(log_path);
+	}
 	if (debug) {
 		init_log(L_DEBUG);
 	} else if (verbose || validate) {
@@ -0,0 +1,102 @@
+#include "clock.h"
+#include "stats.h"
+#include "layout.h"
+#include "trace.h"
+
+// Bucket i counts durations of less than 2^(i+1) nanoseconds, the last one
+// also everything longer
+#define STATS_BUCKETS 40
+
+struct stats_histogram {
+	uint64_t count;
+	uint64_t total_nsec;
+	uint64_t max_nsec;
+	uint64_t buckets[STATS_BUCKETS];
+};
+
+// Only touched from the main loop, so no locking is needed
+static struct stats_histogram histograms[STATS_PROBE_COUNT];
+
+static const char *probe_names[] = {
+	[STATS_OUTPUT_CREATED] = "output_created",
+	[STATS_OUTPUT_DESTROYED] = "output_destroyed",
+	[STATS_OUTPUT_RESOLUTION] = "output_resolution",
+	[STATS_OUTPUT_FOCUS] = "output_focus",
+	[STATS_OUTPUT_PRE_RENDER] = "output_pre_render",
+	[STATS_VIEW_CREATED] = "view_created",
+	[STATS_VIEW_DESTROYED] = "view_destroyed",
+	[STATS_VIEW_GEOMETRY_REQUEST] = "view_geometry_request",
+	[STATS_VIEW_STATE_REQUEST] = "view_state_request",
+	[STATS_KEY] = "key",
+	[STATS_POINTER_MOTION] = "pointer_motion",
+	[STATS_POINTER_BUTTON] = "pointer_button",
+	[STATS_COMMAND] = "command",
+	[STATS_ARRANGE] = "arrange",
+};
+
+uint64_t stats_begin(void) {
+	return clock_now_ns();
+}
+
+void stats_record(enum stats_probe probe, uint64_t start) {
+	uint64_t end = clock_now_ns();
+	uint64_t nsec = end - start;
+	struct stats_histogram *h = &histograms[probe];
+	int bucket = nsec ? 63 - __builtin_clzll(nsec) : 0;
+	if (bucket >= STATS_BUCKETS) {
+		bucket = STATS_BUCKETS - 1;
+	}
+	++h->buckets[bucket];
+	++h->count;
+	h->total_nsec += nsec;
+	if (nsec > h->max_nsec) {
+		h->max_nsec = nsec;
+	}
+	if (trace_enabled) {
+		trace_span(probe_names[probe], "sway", start, end);
+	}
+}
+
+static json_object *histogram_json(const struct stats_histogram *h) {
+	json_object *object = json_object_new_object();
+	json_object_object_add(object, "count", json_object_new_int64(h->count));
+	json_object_object_add(object, "total_nsec", json_object_new_int64(h->total_nsec));
+	json_object_object_add(object, "max_nsec", json_object_new_int64(h->max_nsec));
+	// Non-empty buckets as [upper bound in nanoseconds, count] pairs
+	json_object *buckets = json_object_new_array();
+	int i;
+	for (i = 0; i < STATS_BUCKETS; ++i) {
+		if (!h->buckets[i]) {
+			continue;
+		}
+		json_object *bucket = json_object_new_array();
+		json_object_array_add(bucket, json_object_new_int64((int64_t)1 << (i + 1)));
+		json_object_array_add(bucket, json_object_new_int64(h->buckets[i]));
+		json_object_array_add(buckets, bucket);
+	}
+	json_object_object_add(object, "buckets", buckets);
+	return object;
+}
+
+json_object *stats_json(void) {
+	json_object *histogram_list = json_object_new_object();
+	int i;
+	for (i = 0; i < STATS_PROBE_COUNT; ++i) {
+		json_object_object_add(histogram_list, probe_names[i], histogram_json(&histograms[i]));
+	}
+
+	json_object *counters = json_object_new_object();
+	json_object_object_add(counters, "arrange_requested", json_object_new_int64(layout_stats.arrange_requested));
+	json_object_object_add(counters, "arrange_executed", json_object_new_int64(layout_stats.arrange_executed));
+	json_object_object_add(counters, "geometry_sent", json_object_new_int64(layout_stats.geometry_sent));
+	json_object_object_add(counters, "geometry_skipped", json_object_new_int64(layout_stats.geometry_skipped));
+	json_object_object_add(counters, "transactions", json_object_new_int64(layout_stats.transactions));
+	json_object_object_add(counters, "transaction_views", json_object_new_int64(layout_stats.transaction_views));
+	json_object_object_add(counters, "transaction_compute_usec", json_object_new_int64(layout_stats.transaction_compute_usec));
+	json_object_object_add(counters, "transaction_compute_max_usec", json_object_new_int64(layout_stats.transaction_compute_max_usec));
+
+	json_object *object = json_object_new_object();
+	json_object_object_add(object, "histograms", histogram_list);
+	json_object_object_add(object, "counters", counters);
+	return object;
+}
@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "trace.h"
+#include "log.h"
+
+// Recording stops when the buffer holds this many spans
+#define TRACE_MAX_SPANS (1 << 20)
+
+struct trace_span {
+	const char *name;
+	const char *category;
+	uint64_t start;
+	uint64_t end;
+};
+
+bool trace_enabled = false;
+
+static struct trace_span *spans = NULL;
+static int spans_length = 0;
+static int spans_capacity = 0;
+static unsigned long spans_dropped = 0;
+
+void trace_span(const char *name, const char *category, uint64_t start, uint64_t end) {
+	if (spans_length == spans_capacity) {
+		int capacity = spans_capacity ? spans_capacity * 2 : 4096;
+		struct trace_span *new_spans = NULL;
+		if (capacity <= TRACE_MAX_SPANS) {
+			new_spans = realloc(spans, capacity * sizeof(struct trace_span));
+		}
+		if (!new_spans) {
+			++spans_dropped;
+			return;
+		}
+		spans = new_spans;
+		spans_capacity = capacity;
+	}
+	spans[spans_length++] = (struct trace_span){ name, category, start, end };
+}
+
+void trace_start(void) {
+	spans_length = 0;
+	spans_dropped = 0;
+	trace_enabled = true;
+	sway_log(L_INFO, "Tracing started");
+}
+
+void trace_stop(void) {
+	trace_enabled = false;
+	sway_log(L_INFO, "Tracing stopped, %d spans recorded", spans_length);
+}
+
+bool trace_save(const char *path) {
+	FILE *f = fopen(path, "w");
+	if (!f) {
+		sway_log_errno(L_ERROR, "Unable to open %s for writing", path);
+		return false;
+	}
+	if (spans_dropped) {
+		sway_log(L_ERROR, "Trace buffer was full, %lu spans dropped", spans_dropped);
+	}
+	int pid = getpid();
+	fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	int i;
+	for (i = 0; i < spans_length; ++i) {
+		struct trace_span *span = &spans[i];
+		// Timestamps are in microseconds
+		fprintf(f, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+				"\"ts\":%llu.%03llu,\"dur\":%llu.%03llu}%s\n",
+				span->name, span->category, pid, pid,
+				(unsigned long long)(span->start / 1000), (unsigned long long)(span->start % 1000),
+				(unsigned long long)((span->end - span->start) / 1000),
+				(unsigned long long)((span->end - span->start) % 1000),
+				i + 1 < spans_length ? "," : "");
+	}
+	fprintf(f, "]}\n");
+	if (fclose(f) != 0) {
+		sway_log_errno(L_ERROR, "Unable to write trace to %s", path);
+		return false;
+	}
+	sway_log(L_INFO, "Wrote %d spans to %s", spans_length, path);
+	return true;
+}
@@ -3,6 +3,7 @@
 #include <wlc/wlc.h>
 #include <string.h>
 #include <strings.h>
+#include <ctype.h>
 #include "workspace.h"
 #include "layout.h"
 #include "list.h"
@@ -14,55 +15,65 @@
 #include "focus.h"
 #include "util.h"
 #include "ipc.h"
+#include "hash.h"
 
 char *prev_workspace_name = NULL;
 
+// Workspaces by a hash of their case folded name. Names whose hashes collide
+// can't all be indexed, those are found by searching the tree instead.
+static hash_t *workspace_names = NULL;
+static int workspace_name_collisions = 0;
+
+uint64_t workspace_name_key(const char *name) {
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ULL;
+	for (; *name; ++name) {
+		hash ^= (unsigned char)tolower((unsigned char)*name);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+void workspace_index_add(swayc_t *workspace) {
+	if (!workspace_names) {
+		workspace_names = create_hash();
+	}
+	uint64_t key = workspace_name_key(workspace->name);
+	if (hash_get(workspace_names, key)) {
+		++workspace_name_collisions;
+	} else {
+		hash_set(workspace_names, key, workspace);
+	}
+}
+
+void workspace_index_remove(swayc_t *workspace) {
+	if (!workspace_names) {
+		return;
+	}
+	uint64_t key = workspace_name_key(workspace->name);
+	if (hash_get(workspace_names, key) == workspace) {
+		hash_del(workspace_names, key);
+	} else if (workspace_name_collisions > 0) {
+		--workspace_name_collisions;
+	}
+}
+
 char *workspace_next_name(void) {
 	sway_log(L_DEBUG, "Workspace: Generating new name");
 	int i;
 	int l = 1;
-	// Scan all workspace bindings to find the next available workspace name,
-	// if none are found/available then default to a number
+	// Take the first workspace bound in the current mode that doesn't exist
+	// yet, if there is none then default to a number
 	struct sway_mode *mode = config->current_mode;
-
-	for (i = 0; i < mode->bindings->length; ++i) {
-		struct sway_binding *binding = mode->bindings->items[i];
-		const char* command = binding->command;
-		list_t *args = split_string(command, " ");
-
-		if (strcmp("workspace", args->items[0]) == 0 && args->length > 1) {
-			sway_log(L_DEBUG, "Got valid workspace command for target: '%s'", (char *)args->items[1]);
-			char* target = malloc(strlen(args->items[1]) + 1);
-			strcpy(target, args->items[1]);
-			while (*target == ' ' || *target == '\t')
-				target++;
-
-			// Make sure that the command references an actual workspace
-			// not a command about workspaces
-			if (strcmp(target, "next") == 0 ||
-				strcmp(target, "prev") == 0 ||
-				strcmp(target, "next_on_output") == 0 ||
-				strcmp(target, "prev_on_output") == 0 ||
-				strcmp(target, "number") == 0 ||
-				strcmp(target, "back_and_forth") == 0 ||
-				strcmp(target, "current") == 0)
-			{
-				free_flat_list(args);
-				continue;
-			}
-
-			// Make sure that the workspace doesn't already exist
-			if (workspace_by_name(target)) {
-				free_flat_list(args);
-				continue;
-			}
-
-			free_flat_list(args);
-
+	if (!mode->workspace_names) {
+		compile_mode_bindings(mode);
+	}
+	for (i = 0; i < mode->workspace_names->length; ++i) {
+		const char *target = mode->workspace_names->items[i];
+		if (!workspace_by_name(target)) {
 			sway_log(L_DEBUG, "Workspace: Found free name %s", target);
-			return target;
+			return strdup(target);
 		}
-		free_flat_list(args);
 	}
 	// As a fall back, get the current number of active workspaces
 	// and return that + 1 for the next workspace's name
@@ -124,7 +135,21 @@ swayc_t *workspace_by_name(const char* name) {
 		return swayc_active_workspace();
 	}
 	else {
-		return swayc_by_test(&root_container, _workspace_by_name, (void *) name);
+		swayc_t *ws = workspace_names ? hash_get(workspace_names, workspace_name_key(name)) : NULL;
+		if (ws && strcasecmp(ws->name, name) == 0) {
+			return ws;
+		}
+		if (workspace_name_collisions == 0) {
+			return NULL;
+		}
+		struct swayc_iter iter;
+		swayc_iter_init(&iter, &root_container, C_WORKSPACE);
+		while ((ws = swayc_iter_next(&iter))) {
+			if (_workspace_by_name(ws, (void *) name)) {
+				return ws;
+			}
+		}
+		return NULL;
 	}
 }
 
@@ -138,15 +163,11 @@ swayc_t *workspace_output_prev_next_impl(swayc_t *output, bool next) {
 		return NULL;
 	}
 
-	int i;
-	for (i = 0; i < output->children->length; i++) {
-		if (output->children->items[i] == output->focused) {
-			return output->children->items[wrap(i + (next ? 1 : -1), output->children->length)];
-		}
+	if (!output->focused) {
+		return NULL;
 	}
-
-	// Doesn't happen, at worst the for loop returns the previously active workspace
-	return NULL;
+	int i = index_child(output->focused);
+	return output->children->items[wrap(i + (next ? 1 : -1), output->children->length)];
 }
 
 /**
@@ -161,26 +182,16 @@ swayc_t *workspace_prev_next_impl(swayc_t *workspace, bool next) {
 
 	swayc_t *current_output = workspace->parent;
 	int offset = next ? 1 : -1;
-	int start = next ? 0 : 1;
-	int end = next ? (current_output->children->length) - 1 : current_output->children->length;
-	int i;
-	for (i = start; i < end; i++) {
-		if (current_output->children->items[i] == workspace) {
-			return current_output->children->items[i + offset];
-		}
+	int i = index_child(workspace) + offset;
+	if (i >= 0 && i < current_output->children->length) {
+		return current_output->children->items[i];
 	}
 
 	// Given workspace is the first/last on the output, jump to the previous/next output
 	int num_outputs = root_container.children->length;
-	for (i = 0; i < num_outputs; i++) {
-		if (root_container.children->items[i] == current_output) {
-			swayc_t *next_output = root_container.children->items[wrap(i + offset, num_outputs)];
-			return workspace_output_prev_next_impl(next_output, next);
-		}
-	}
-
-	// Doesn't happen, at worst the for loop returns the previously active workspace on the active output
-	return NULL;
+	i = index_child(current_output);
+	swayc_t *next_output = root_container.children->items[wrap(i + offset, num_outputs)];
+	return workspace_output_prev_next_impl(next_output, next);
 }
 
 swayc_t *workspace_output_next() {